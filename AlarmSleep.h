@@ -0,0 +1,158 @@
+#ifndef ALARM_SLEEP_H
+#define ALARM_SLEEP_H
+
+/*
+ * Deep sleep until a given time, on the SAMD21's own RTC. With AUTO_UNLOCK defined, a time-locked
+ * box sleeps this way until the lock expires, so it unlocks itself without anyone pressing a
+ * button. (This needs the box to be left switched on.)
+ *
+ * The XIAO has no 32 kHz crystal, so the RTC runs from the SAMD21's internal ultra-low-power
+ * oscillator, which can be off by several percent: over a 29-day lock, that is more than a day.
+ * The RTC is therefore measured against the DS1302 in three ways:
+ *  - Before the first alarm sleep after power-on, the RTC's clock is counted over
+ *    ALARM_CALIBRATION_SECONDS of the DS1302 (good to about 500 ppm, and keeps the box awake for
+ *    up to three seconds).
+ *  - Every alarm sleep that is long enough is measured against the DS1302, and the drift learned
+ *    from all of them replaces the first measurement. The DS1302 counts whole seconds, so a
+ *    single sleep is only good to a second, but the errors average out as the sleeps add up.
+ *  - A sleep lasts at most ALARM_MAX_SLEEP, and is shortened by ALARM_MARGIN_PPM. The box then
+ *    reads the DS1302 and sleeps again for what is left, so an error in the drift makes it wake up
+ *    a few extra times rather than late.
+ * The last sleep ends ALARM_LEAD seconds early, so that the RTC's one-second alarm resolution
+ * leaves the box awake for a moment before the expiry instead of after it.
+ */
+
+#define ALARM_LEAD 2 //Seconds before the given time to wake up
+#define ALARM_CALIBRATION_MIN 600 //Shortest sleep, in seconds, that is used to learn the drift
+#define ALARM_CALIBRATION_SECONDS 2 //Length of the measurement before the first sleep
+#define ALARM_MAX_SLEEP 86400 //Longest single sleep, in seconds
+#define ALARM_MARGIN_PPM 2000 //How much shorter a sleep is made than the drift says
+
+static volatile bool alarm_fired = false;
+static uint64_t alarm_rtc_ms = 0; //Total length of the measured sleeps on the SAMD21's RTC
+static uint64_t alarm_clock_s = 0; //Total length of the same sleeps on the DS1302
+static int32_t alarm_drift_ppm = 0; //How much faster the SAMD21's RTC runs than the DS1302
+static bool alarm_calibrated = false; //Whether alarm_drift_ppm has been measured since power-on
+
+#if defined(__SAMD21G18A__)
+
+//The RTC library clocks the RTC from generic clock 2 at 1024 Hz. TC3, which nothing else uses,
+//counts the same clock for the measurement.
+#define ALARM_COUNTER_HZ 1024
+
+void alarmCounterStart(){
+  GCLK->CLKCTRL.reg = GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK2 | GCLK_CLKCTRL_ID_TCC2_TC3;
+  while(GCLK->STATUS.bit.SYNCBUSY);
+  PM->APBCMASK.reg |= PM_APBCMASK_TC3;
+  TC3->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+  while(TC3->COUNT16.CTRLA.bit.SWRST);
+  TC3->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_PRESCALER_DIV1 | TC_CTRLA_ENABLE;
+  while(TC3->COUNT16.STATUS.bit.SYNCBUSY);
+}
+
+uint16_t alarmCounterRead(){
+  TC3->COUNT16.READREQ.reg = TC_READREQ_RREQ | TC_READREQ_ADDR(TC_COUNT16_COUNT_OFFSET);
+  while(TC3->COUNT16.STATUS.bit.SYNCBUSY);
+  return TC3->COUNT16.COUNT.reg;
+}
+
+void alarmCounterStop(){
+  TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  while(TC3->COUNT16.STATUS.bit.SYNCBUSY);
+  PM->APBCMASK.reg &= ~PM_APBCMASK_TC3;
+  GCLK->CLKCTRL.reg = GCLK_CLKCTRL_GEN_GCLK2 | GCLK_CLKCTRL_ID_TCC2_TC3; //Clock off
+  while(GCLK->STATUS.bit.SYNCBUSY);
+}
+
+#else
+
+//The host simulation's RTC sleeps run on the virtual clock, as does millis().
+#define ALARM_COUNTER_HZ 1000
+
+void alarmCounterStart(){}
+
+uint16_t alarmCounterRead(){
+  return (uint16_t)millis();
+}
+
+void alarmCounterStop(){}
+
+#endif
+
+void alarmInterrupt(){
+  alarm_fired = true;
+}
+
+//Waits for the DS1302 to count past the given second, and reads the counter at that moment.
+//Returns false if the DS1302 does not tick.
+bool alarmWaitForSecond(uint32_t after, uint16_t& counter){
+  unsigned long started = millis();
+  while(true){
+    invalidateClock();
+    if(currentTimestamp() > after){
+      counter = alarmCounterRead();
+      return true;
+    }
+    if(millis() - started > 1500){
+      return false;
+    }
+  }
+}
+
+//Measures alarm_drift_ppm over ALARM_CALIBRATION_SECONDS of the DS1302. The RTC must be running.
+void alarmCalibrate(){
+  uint16_t start_count, end_count;
+  alarmCounterStart();
+  invalidateClock();
+  uint32_t start = currentTimestamp();
+  bool ticking = alarmWaitForSecond(start, start_count);
+  for(uint8_t i = 1; ticking && i <= ALARM_CALIBRATION_SECONDS; i++){
+    ticking = alarmWaitForSecond(start + i, end_count);
+  }
+  if(ticking){
+    int32_t expected = ALARM_COUNTER_HZ * ALARM_CALIBRATION_SECONDS;
+    int32_t counted = (uint16_t)(end_count - start_count);
+    alarm_drift_ppm = (int32_t)((int64_t)(counted - expected) * 1000000 / expected);
+    alarm_calibrated = true;
+  }
+  alarmCounterStop();
+}
+
+//Sleeps until the DS1302 reaches wake_time, or until a button wakes the box. Returns right away
+//if that is less than ALARM_LEAD seconds off.
+void alarmDeepSleep(uint32_t wake_time){
+  LowPower.attachInterruptWakeup(RTC_ALARM_WAKEUP, alarmInterrupt, CHANGE); //Also starts the RTC
+  if(!alarm_calibrated){
+    alarmCalibrate();
+  }
+  while(true){
+    invalidateClock(); //Both ends of the measurement are fresh DS1302 readings, which are off by the same fraction of a second on average
+    uint32_t start = currentTimestamp();
+    if(wake_time <= start + ALARM_LEAD){
+      return;
+    }
+    uint32_t seconds = wake_time - start - ALARM_LEAD;
+    if(seconds > ALARM_MAX_SLEEP){
+      seconds = ALARM_MAX_SLEEP;
+    }
+    int64_t rate_ppm = 1000000 + (int64_t)alarm_drift_ppm - ALARM_MARGIN_PPM;
+    uint32_t sleep_ms = (uint32_t)((int64_t)seconds * 1000 * rate_ppm / 1000000);
+    if(sleep_ms < 1000){ //Shorter than the RTC's resolution: stay awake for the rest
+      return;
+    }
+    alarm_fired = false;
+    LowPower.deepSleep(sleep_ms);
+    if(!alarm_fired){ //Woken by a button
+      return;
+    }
+
+    if(sleep_ms >= ALARM_CALIBRATION_MIN * 1000UL){ //Only the alarm tells how long the RTC ran
+      invalidateClock(); //millis() did not advance during the sleep
+      alarm_rtc_ms += sleep_ms;
+      alarm_clock_s += currentTimestamp() - start;
+      alarm_drift_ppm = (int32_t)(((int64_t)alarm_rtc_ms - (int64_t)alarm_clock_s * 1000) * 1000 / (int64_t)alarm_clock_s);
+    }
+  }
+}
+
+#endif
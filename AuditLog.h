@@ -0,0 +1,261 @@
+#ifndef AUDIT_LOG_H
+#define AUDIT_LOG_H
+
+/*
+ * History of locks, unlocks, wrong PINs and expired time locks, kept in a circular log in flash.
+ *
+ * Entries are appended to the next free slot and never rewritten. The log always keeps the row
+ * after the one being written erased (the spare row), so appending an entry is a single flash
+ * write; when the log moves into the spare row, the oldest row becomes the new spare row and is
+ * erased later from a timer, outside the button handler. Every row is erased once per pass of
+ * the log, so the wear is spread evenly over the region.
+ *
+ * The entries are in time order, and the time of the first entry of each row is kept in RAM.
+ * auditFind() binary searches these, and then the row, so finding the entries of a given day
+ * takes about a dozen flash reads however long the log is.
+ *
+ * Each entry carries a sequence number, which continues from row to row. At power-on the row
+ * whose successor does not continue its sequence is the one being written.
+ */
+
+#define AUDIT_LOCKED 1 //Locked with the PIN
+#define AUDIT_UNLOCKED 2 //Unlocked with the PIN
+#define AUDIT_WRONG_PIN 3
+#define AUDIT_TIME_LOCKED 4
+#define AUDIT_TIME_LOCK_EXPIRED 5
+#define AUDIT_TYPES 6
+
+const char* const audit_type_names[AUDIT_TYPES] = {"", "Locked", "Unlocked", "Wrong PIN", "Time lock", "Expired"};
+
+#define AUDIT_ENTRY_SIZE 8
+#define AUDIT_LOG_ROWS 64 //16 KB of flash
+#define AUDIT_ENTRIES_PER_ROW (FLASH_ROW_SIZE / AUDIT_ENTRY_SIZE)
+#define AUDIT_SLOTS (AUDIT_LOG_ROWS * AUDIT_ENTRIES_PER_ROW)
+#define AUDIT_CAPACITY ((AUDIT_LOG_ROWS - 1) * AUDIT_ENTRIES_PER_ROW) //All rows but the spare row: 2016 entries
+#define AUDIT_ERASE_DELAY 2000 //How long after it is needed the spare row is erased
+
+struct AuditEntry{
+  uint32_t time; //UNIX time
+  uint16_t sequence; //Continues across rows (wraps around)
+  uint8_t type; //One of the AUDIT_* types; 0xFF in an erased slot
+  uint8_t state_id; //The state the box was in
+};
+
+static_assert(sizeof(AuditEntry) == AUDIT_ENTRY_SIZE, "An entry must fill its slot exactly");
+
+//Reserve the flash region for the log (same layout as the FlashStorage library uses):
+__attribute__((__aligned__(FLASH_ROW_SIZE)))
+static const uint8_t audit_log[AUDIT_LOG_ROWS * FLASH_ROW_SIZE] = {};
+static FlashClass audit_flash(audit_log, sizeof(audit_log));
+
+static uint32_t audit_row_time[AUDIT_LOG_ROWS]; //Time of the first entry of each row: the index
+static uint16_t audit_write_slot = 0; //The slot the next entry will be written to
+static uint16_t audit_count = 0; //Entries in the log; the oldest one is at the start of a row
+static uint16_t audit_next_sequence = 0;
+
+void auditMaintain();
+static Timer audit_erase_timer = {auditMaintain};
+
+void auditReadSlot(uint16_t slot, AuditEntry& entry){
+  audit_flash.read(&audit_log[slot * AUDIT_ENTRY_SIZE], &entry, AUDIT_ENTRY_SIZE);
+}
+
+bool auditValid(const AuditEntry& entry){
+  return entry.type > 0 && entry.type < AUDIT_TYPES;
+}
+
+bool auditSlotErased(uint16_t slot){
+  AuditEntry entry;
+  auditReadSlot(slot, entry);
+  const uint8_t* bytes = (const uint8_t*)&entry;
+  for(uint8_t i = 0; i < AUDIT_ENTRY_SIZE; i++){
+    if(bytes[i] != 0xFF){
+      return false;
+    }
+  }
+  return true;
+}
+
+//Whether every slot of a row is erased (a row that was never written since upload holds zeros):
+bool auditRowErased(uint16_t row){
+  for(uint8_t i = 0; i < AUDIT_ENTRIES_PER_ROW; i++){
+    if(!auditSlotErased(row * AUDIT_ENTRIES_PER_ROW + i)){
+      return false;
+    }
+  }
+  return true;
+}
+
+void auditEraseRow(uint16_t row){
+  trace(TRACE_FLASH_WRITE, TRACE_FLASH_AUDIT, 1);
+  noInterrupts();
+  audit_flash.erase(&audit_log[row * FLASH_ROW_SIZE], FLASH_ROW_SIZE);
+  interrupts();
+}
+
+//Whether the first entry of row continues the sequence of a row starting with sequence:
+bool auditRowFollows(uint16_t row, uint16_t sequence){
+  AuditEntry entry;
+  auditReadSlot(row * AUDIT_ENTRIES_PER_ROW, entry);
+  return auditValid(entry) && entry.sequence == (uint16_t)(sequence + AUDIT_ENTRIES_PER_ROW);
+}
+
+//Finds the end of the log and builds the index. Called once in setup().
+void auditInit(){
+  AuditEntry entry;
+  int16_t head_row = -1;
+  for(uint16_t row = 0; row < AUDIT_LOG_ROWS && head_row < 0; row++){
+    auditReadSlot(row * AUDIT_ENTRIES_PER_ROW, entry);
+    if(auditValid(entry) && !auditRowFollows((row + 1) % AUDIT_LOG_ROWS, entry.sequence)){
+      head_row = row;
+    }
+  }
+  if(head_row < 0){ //Nothing logged yet
+    audit_write_slot = 0;
+    audit_count = 0;
+    audit_next_sequence = 0;
+  }else{
+    uint8_t fill = 0;
+    while(fill < AUDIT_ENTRIES_PER_ROW){
+      auditReadSlot(head_row * AUDIT_ENTRIES_PER_ROW + fill, entry);
+      if(!auditValid(entry)){
+        break;
+      }
+      audit_next_sequence = entry.sequence + 1;
+      fill++;
+    }
+    audit_write_slot = (head_row * AUDIT_ENTRIES_PER_ROW + fill) % AUDIT_SLOTS;
+    audit_count = fill;
+
+    //Walk back through the rows that lead up to the head row, indexing them:
+    uint16_t row = head_row;
+    auditReadSlot(row * AUDIT_ENTRIES_PER_ROW, entry);
+    audit_row_time[row] = entry.time;
+    for(uint16_t back = 0; back < AUDIT_LOG_ROWS - 2; back++){
+      uint16_t previous = (row + AUDIT_LOG_ROWS - 1) % AUDIT_LOG_ROWS;
+      AuditEntry first;
+      auditReadSlot(previous * AUDIT_ENTRIES_PER_ROW, first);
+      if(!auditValid(first) || (uint16_t)(first.sequence + AUDIT_ENTRIES_PER_ROW) != entry.sequence){
+        break;
+      }
+      audit_row_time[previous] = first.time;
+      audit_count += AUDIT_ENTRIES_PER_ROW;
+      row = previous;
+      entry = first;
+    }
+  }
+  timerStart(audit_erase_timer, AUDIT_ERASE_DELAY); //Make sure the row being written and the spare row are erased
+}
+
+//Erases the row being written (if the log is about to enter it) and the spare row, if they are not
+//erased yet. Runs from audit_erase_timer, so the erase never holds up a button press.
+void auditMaintain(){
+  uint16_t row = audit_write_slot / AUDIT_ENTRIES_PER_ROW;
+  if(audit_write_slot % AUDIT_ENTRIES_PER_ROW == 0 && !auditRowErased(row)){
+    auditEraseRow(row);
+  }
+  uint16_t spare = (row + 1) % AUDIT_LOG_ROWS;
+  if(!auditRowErased(spare)){
+    auditEraseRow(spare);
+  }
+}
+
+//Appends an entry for an event in the current state.
+void audit(uint8_t type){
+  uint16_t slot = audit_write_slot;
+  if(!auditSlotErased(slot)){ //Only if the erase timer has not run yet, or a write was cut short by a power loss
+    if(slot % AUDIT_ENTRIES_PER_ROW != 0){ //Leave the rest of a damaged row, keeping its slots in the sequence
+      uint8_t skipped = AUDIT_ENTRIES_PER_ROW - slot % AUDIT_ENTRIES_PER_ROW;
+      slot = (slot + skipped) % AUDIT_SLOTS;
+      audit_count += skipped;
+      audit_next_sequence += skipped;
+    }
+    if(!auditSlotErased(slot)){
+      auditEraseRow(slot / AUDIT_ENTRIES_PER_ROW);
+    }
+  }
+
+  AuditEntry entry;
+  entry.time = currentTimestamp();
+  entry.sequence = audit_next_sequence++;
+  entry.type = type;
+  entry.state_id = curr_state_id;
+  if(slot % AUDIT_ENTRIES_PER_ROW == 0){ //Entering the spare row: the oldest row becomes the new spare row
+    audit_count = min(audit_count, (uint16_t)((AUDIT_LOG_ROWS - 2) * AUDIT_ENTRIES_PER_ROW));
+    audit_row_time[slot / AUDIT_ENTRIES_PER_ROW] = entry.time;
+    timerStart(audit_erase_timer, AUDIT_ERASE_DELAY);
+  }
+  trace(TRACE_FLASH_WRITE, TRACE_FLASH_AUDIT, 0);
+  noInterrupts();
+  audit_flash.write(&audit_log[slot * AUDIT_ENTRY_SIZE], &entry, AUDIT_ENTRY_SIZE);
+  interrupts();
+  audit_write_slot = (slot + 1) % AUDIT_SLOTS;
+  audit_count++;
+}
+
+//Reads the entry at index, where 0 is the oldest entry and audit_count - 1 the newest. The slots
+//left after a damaged entry are in the count too, and read back as invalid entries (see auditValid()).
+void auditRead(uint16_t index, AuditEntry& entry){
+  auditReadSlot((audit_write_slot + AUDIT_SLOTS - audit_count + index) % AUDIT_SLOTS, entry);
+}
+
+//The index of the first entry logged at or after time (audit_count if there is none).
+uint16_t auditFind(uint32_t time){
+  if(audit_count == 0){
+    return 0;
+  }
+  uint16_t oldest_row = (audit_write_slot + AUDIT_SLOTS - audit_count) % AUDIT_SLOTS / AUDIT_ENTRIES_PER_ROW;
+  uint16_t rows = (audit_count + AUDIT_ENTRIES_PER_ROW - 1) / AUDIT_ENTRIES_PER_ROW;
+
+  //The last row that starts before time:
+  uint16_t low = 0, high = rows;
+  while(low < high){
+    uint16_t middle = (low + high) / 2;
+    if(audit_row_time[(oldest_row + middle) % AUDIT_LOG_ROWS] < time){
+      low = middle + 1;
+    }else{
+      high = middle;
+    }
+  }
+  if(low == 0){
+    return 0;
+  }
+
+  //The first entry of that row at or after time:
+  uint16_t first = (low - 1) * AUDIT_ENTRIES_PER_ROW;
+  low = first + 1; //The first entry of the row is before time
+  high = min((uint16_t)(first + AUDIT_ENTRIES_PER_ROW), audit_count);
+  while(low < high){
+    uint16_t middle = (low + high) / 2;
+    AuditEntry entry;
+    auditRead(middle, entry);
+    if(entry.time < time){
+      low = middle + 1;
+    }else{
+      high = middle;
+    }
+  }
+  return low;
+}
+
+//Writes the log to the serial port, oldest first, as audit=<time>,<type>,<state ID> lines.
+void printAuditLog(){
+  if(!Serial){
+    return;
+  }
+  AuditEntry entry;
+  for(uint16_t index = 0; index < audit_count; index++){
+    auditRead(index, entry);
+    if(!auditValid(entry)){
+      continue;
+    }
+    Serial.print("audit=");
+    Serial.print((unsigned long)entry.time);
+    Serial.print(',');
+    Serial.print(audit_type_names[entry.type]);
+    Serial.print(',');
+    Serial.println(entry.state_id);
+  }
+}
+
+#endif
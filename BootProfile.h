@@ -0,0 +1,42 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+/*
+ * Timestamps of the phases of setup(), in microseconds since setup() started. The box is switched
+ * off while it is locked, so setup() runs every time it is used. The profile is shown on the
+ * diagnostics screen and included in the serial report.
+ */
+
+#define BOOT_STATE_LOADED 0 //The stored state has been read from flash
+#define BOOT_DISPLAY_READY 1 //The display has been initialized
+#define BOOT_FIRST_FRAME 2 //The first screen has been sent to the display
+#define BOOT_DONE 3 //Deferred setup is done and loop() starts
+#define BOOT_PHASES 4
+
+const char* const boot_phase_names[BOOT_PHASES] = {"state_loaded", "display_ready", "first_frame", "done"};
+
+static unsigned long boot_start_us = 0; //micros() when setup() started
+static uint32_t boot_phase_us[BOOT_PHASES];
+
+void bootStart(){
+  boot_start_us = micros();
+}
+
+void bootMark(uint8_t phase){
+  boot_phase_us[phase] = micros() - boot_start_us;
+}
+
+//Writes the phases to the serial port as name=value lines.
+void printBootProfile(){
+  if(!Serial){
+    return;
+  }
+  for(uint8_t phase = 0; phase < BOOT_PHASES; phase++){
+    Serial.print("boot_");
+    Serial.print(boot_phase_names[phase]);
+    Serial.print("_us=");
+    Serial.println((unsigned long)boot_phase_us[phase]);
+  }
+}
+
+#endif
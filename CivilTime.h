@@ -0,0 +1,100 @@
+#ifndef CIVIL_TIME_H
+#define CIVIL_TIME_H
+
+/*
+ * Conversion between UNIX timestamps and calendar dates, using Howard Hinnant's days_from_civil
+ * and civil_from_days algorithms (https://howardhinnant.github.io/date_algorithms.html). These
+ * count in eras of 400 years starting on March 1, so leap days fall at the end of a year and no
+ * month table is needed.
+ *
+ * All functions are constexpr (in the single-return form C++11 requires), so dates known at
+ * compile time cost nothing and the checks at the end of this file run in the compiler. The
+ * arithmetic is unsigned and covers every 32-bit timestamp, from 1970-01-01 to 2106-02-07.
+ */
+
+struct CivilDate{
+  uint16_t year;
+  uint8_t month; //1 to 12
+  uint8_t day; //1 to 31
+};
+
+struct CivilSpan{
+  uint32_t days;
+  uint8_t hours;
+  uint8_t minutes;
+  uint8_t seconds;
+};
+
+//Days from March 1 to the first of the given month, plus the day of the month:
+constexpr uint32_t civilDayOfYear(uint32_t month, uint32_t day){
+  return (153*(month > 2 ? month - 3 : month + 9) + 2)/5 + day - 1;
+}
+
+//Days from the start of the era to a day of a year of the era (years starting on March 1):
+constexpr uint32_t civilDayOfEra(uint32_t year_of_era, uint32_t day_of_year){
+  return year_of_era*365 + year_of_era/4 - year_of_era/100 + day_of_year;
+}
+
+//Days since 1970-01-01 of a day of a year starting on March 1:
+constexpr uint32_t civilDaysFromMarchYear(uint32_t year, uint32_t day_of_year){
+  return year/400*146097 + civilDayOfEra(year % 400, day_of_year) - 719468;
+}
+
+//Days since 1970-01-01 (days_from_civil):
+constexpr uint32_t daysFromCivil(uint32_t year, uint32_t month, uint32_t day){
+  return civilDaysFromMarchYear(year - (month <= 2), civilDayOfYear(month, day));
+}
+
+constexpr uint32_t civilToTimestamp(uint32_t year, uint32_t month, uint32_t day, uint32_t hour, uint32_t minute, uint32_t second){
+  return ((daysFromCivil(year, month, day)*24 + hour)*60 + minute)*60 + second;
+}
+
+//The year of the era (years starting on March 1) that a day of the era falls in:
+constexpr uint32_t civilYearOfEra(uint32_t day_of_era){
+  return (day_of_era - day_of_era/1460 + day_of_era/36524 - day_of_era/146096) / 365;
+}
+
+//month_index counts from March (0) to February (11):
+constexpr CivilDate civilFromMonthIndex(uint32_t march_year, uint32_t day_of_year, uint32_t month_index){
+  return CivilDate{(uint16_t)(march_year + (month_index >= 10)), (uint8_t)(month_index < 10 ? month_index + 3 : month_index - 9),
+                   (uint8_t)(day_of_year - (153*month_index + 2)/5 + 1)};
+}
+
+constexpr CivilDate civilFromDayOfYear(uint32_t march_year, uint32_t day_of_year){
+  return civilFromMonthIndex(march_year, day_of_year, (5*day_of_year + 2)/153);
+}
+
+constexpr CivilDate civilFromYearOfEra(uint32_t era, uint32_t day_of_era, uint32_t year_of_era){
+  return civilFromDayOfYear(era*400 + year_of_era, day_of_era - civilDayOfEra(year_of_era, 0));
+}
+
+constexpr CivilDate civilFromEra(uint32_t era, uint32_t day_of_era){
+  return civilFromYearOfEra(era, day_of_era, civilYearOfEra(day_of_era));
+}
+
+//The date of a day counted from 1970-01-01 (civil_from_days):
+constexpr CivilDate civilFromDays(uint32_t days){
+  return civilFromEra((days + 719468) / 146097, (days + 719468) % 146097);
+}
+
+//0 = Sunday (1970-01-01 was a Thursday):
+constexpr uint8_t weekdayFromDays(uint32_t days){
+  return (days + 4) % 7;
+}
+
+constexpr CivilSpan spanFromSeconds(uint32_t seconds){
+  return CivilSpan{seconds / 86400, (uint8_t)(seconds / 3600 % 24), (uint8_t)(seconds / 60 % 60), (uint8_t)(seconds % 60)};
+}
+
+//Checked at compile time:
+static_assert(daysFromCivil(1970, 1, 1) == 0, "UNIX epoch");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "Leap day of a century divisible by 400");
+static_assert(civilToTimestamp(2021, 8, 21, 12, 0, 0) == 1629547200, "A known timestamp");
+static_assert(civilToTimestamp(2106, 2, 7, 6, 28, 15) == 0xFFFFFFFF, "The last 32-bit timestamp");
+static_assert(civilFromDays(11016).month == 2 && civilFromDays(11016).day == 29, "2000-02-29");
+static_assert(civilFromDays(0xFFFFFFFF / 86400).year == 2106 && civilFromDays(0xFFFFFFFF / 86400).day == 7, "2106-02-07");
+static_assert(civilFromDays(daysFromCivil(2100, 3, 1)).month == 3, "2100 is not a leap year");
+static_assert(weekdayFromDays(daysFromCivil(2021, 8, 21)) == 6, "2021-08-21 was a Saturday");
+static_assert(spanFromSeconds(93784).days == 1 && spanFromSeconds(93784).minutes == 3, "1d 2h 3m 4s");
+
+#endif
@@ -1,9 +1,7 @@
 #ifndef CLOCK_COMMANDS_H
 #define CLOCK_COMMANDS_H
 
-static timestamp32bits stamp;
-
-String dayAsString(const Time::Day day) { //This function is taken from the DS1302.h sample code (see link in LockBoxCode.ino)
+const char* dayAsString(const Time::Day day) { //This function is taken from the DS1302.h sample code (see link in LockBoxCode.ino)
   switch (day) {
     case Time::kSunday: return "Sunday";
     case Time::kMonday: return "Monday";
@@ -16,16 +14,65 @@ String dayAsString(const Time::Day day) { //This function is taken from the DS13
   return "(unknown day)";
 }
 
-String spanAsString(TimeSpan& span){
-  return String("")+span.days()+"d "+span.hours()+"h "+span.minutes()+"m "+span.seconds()+"s";
+TextBuffer spanAsString(const CivilSpan& span){
+  TextBuffer text;
+  text.appendNumber(span.days).append("d ").appendNumber(span.hours).append("h ");
+  text.appendNumber(span.minutes).append("m ").appendNumber(span.seconds).append('s');
+  return text;
+}
+
+TextBuffer timeAsString(Time& t){
+  TextBuffer text;
+  text.appendNumber(t.mon).append('/').appendNumber(t.date).append('/').appendNumber(t.yr-2000).append(' ');
+  text.appendNumber(t.hr).append(':').appendNumber(t.min, 2).append(':').appendNumber(t.sec, 2);
+  return text;
 }
 
-String timeAsString(Time& t){
-  return String(t.mon)+"/"+t.date+"/"+(t.yr-2000)+" "+t.hr+":"+(t.min < 10 ? "0" : "")+t.min+":"+(t.sec < 10 ? "0" : "")+t.sec;
+//The inverse of time_to_timestamp():
+Time timestampToTime(uint32_t timestamp){
+  uint32_t days = timestamp / 86400;
+  uint32_t seconds = timestamp % 86400;
+  CivilDate date = civilFromDays(days);
+  Time::Day day = static_cast<Time::Day>(weekdayFromDays(days) + Time::kSunday);
+  return Time(date.year, date.month, date.day, seconds / 3600, seconds / 60 % 60, seconds % 60, day);
 }
 
 uint32_t time_to_timestamp(Time& t){
-  return stamp.timestamp(t.yr-2000, t.mon, t.date, t.hr, t.min, t.sec);
+  return civilToTimestamp(t.yr, t.mon, t.date, t.hr, t.min, t.sec);
+}
+
+//The DS1302 is read over a slow bit-banged serial line, so it is read at most once per tick.
+//Between reads, the last reading stands for the current time.
+static Time clock_time(2000, 1, 1, 0, 0, 0, Time::kSaturday); //The last reading of the DS1302
+static uint32_t clock_timestamp = 0; //clock_time as a UNIX timestamp
+static unsigned long clock_read_at = 0; //millis() at the last reading
+static bool clock_read = false; //Whether the DS1302 has been read since power-on
+
+//Reads the DS1302 (in one burst transfer) if the last reading is a tick or more old.
+void refreshClock(){
+  if(!clock_read || millis() - clock_read_at >= TICK_PERIOD){
+    clock_time = rtc.time();
+    clock_timestamp = time_to_timestamp(clock_time);
+    clock_read_at = millis();
+    clock_read = true;
+  }
+}
+
+//Forces a new reading on the next call, e.g. after deep sleep, during which millis() stands still:
+void invalidateClock(){
+  clock_read = false;
+}
+
+//The time of the last DS1302 reading, which is at most one tick old:
+Time& currentTime(){
+  refreshClock();
+  return clock_time;
+}
+
+//The UNIX timestamp of the last DS1302 reading, which is at most one tick old:
+uint32_t currentTimestamp(){
+  refreshClock();
+  return clock_timestamp;
 }
 
 
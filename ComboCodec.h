@@ -0,0 +1,32 @@
+#ifndef COMBO_CODEC_H
+#define COMBO_CODEC_H
+
+//Conversion between the digit arrays shown on screen and the number stored in flash.
+//The first digit is the most significant one. The number is 64 bits wide, as 10 digits do not fit in 32.
+
+static_assert(COMBO_LENGTH >= 1 && COMBO_LENGTH <= 10, "The screen fits at most 10 digits");
+
+uint64_t packCombo(const uint8_t* digits){
+  uint64_t combo = 0;
+  for(uint8_t i = 0; i < COMBO_LENGTH; i++){
+    combo = combo*10 + digits[i];
+  }
+  return combo;
+}
+
+void unpackCombo(uint64_t combo, uint8_t* digits){
+  for(int8_t i = COMBO_LENGTH - 1; i >= 0; i--){
+    digits[i] = combo % 10;
+    combo /= 10;
+  }
+}
+
+//Compares two combinations without branching on their bits, so the time a check takes does not
+//depend on how close a guess is.
+bool comboEquals(uint64_t a, uint64_t b){
+  uint64_t diff = a ^ b;
+  volatile uint32_t folded = (uint32_t)diff | (uint32_t)(diff >> 32); //volatile keeps the compiler from splitting the test
+  return folded == 0;
+}
+
+#endif
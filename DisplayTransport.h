@@ -0,0 +1,237 @@
+#ifndef DISPLAY_TRANSPORT_H
+#define DISPLAY_TRANSPORT_H
+
+/*
+ * Sends frame buffer pages to the SSD1306 without blocking the CPU.
+ *
+ * fb_flush() queues at most one write per page. Each write is one I2C transaction that carries
+ * its own column/page window as command bytes followed by the pixel data, so a page needs no
+ * separate command transfer. On the SAMD21 the DMA controller feeds the bytes to the I2C
+ * peripheral and the DMA interrupt starts the next queued page, so the main loop can go idle
+ * (see idleUntilNextDeadline()) while the panel is updated. Anything that talks to the panel
+ * through the ssd1306 library must call dt_wait() first, as the library uses the same bus.
+ *
+ * If a write fails (the panel does not acknowledge it, or the bus is stuck), the transaction is
+ * stopped and the rest of the queue is dropped. dt_wait() notices the error, or gives up after
+ * DT_TIMEOUT, and the next fb_flush() sends the whole screen again (see dt_takeFailure()).
+ *
+ * On other targets (the host simulation) the pages are sent right away through the library.
+ */
+
+#define DISPLAY_I2C_ADDRESS 0x3C
+#define DISPLAY_I2C_CLOCK 400000 //Fast mode, the highest clock the SSD1306 datasheet specifies
+#define DT_HEADER_SIZE 13 //Window commands in front of the pixel data of a page
+#define DT_TIMEOUT 100 //Milliseconds dt_wait() waits for the queue before giving up. A full screen takes 26 ms
+
+#if defined(__SAMD21G18A__)
+#define DISPLAY_DMA
+#endif
+
+#ifdef DISPLAY_DMA
+
+#include <Wire.h>
+
+#define DISPLAY_SERCOM SERCOM2 //The SERCOM behind Wire on the XIAO
+#define DISPLAY_DMA_TRIGGER SERCOM2_DMAC_ID_TX
+#define DISPLAY_DMA_CHANNEL 0 //Nothing else in the firmware uses the DMA controller
+
+//The DMA controller reads the channel descriptors from RAM. They must be 16-byte aligned.
+__attribute__((__aligned__(16))) static DmacDescriptor dt_base_descriptor;
+__attribute__((__aligned__(16))) static DmacDescriptor dt_writeback_descriptor;
+__attribute__((__aligned__(16))) static DmacDescriptor dt_data_descriptor; //Linked after the header
+
+static uint8_t dt_headers[SCREEN_PAGES][DT_HEADER_SIZE];
+static const uint8_t* dt_data[SCREEN_PAGES];
+static uint8_t dt_length[SCREEN_PAGES];
+static volatile bool dt_failed = false; //A write failed since the last dt_takeFailure()
+
+#endif
+
+static volatile uint8_t dt_pending = 0; //One bit per queued page
+static volatile bool dt_active = false; //A page is being sent
+
+//Call once after ssd1306_128x64_i2c_init().
+void dt_init(){
+#ifdef DISPLAY_DMA
+  Wire.setClock(DISPLAY_I2C_CLOCK);
+
+  //The window commands below only work in horizontal addressing mode:
+  Wire.beginTransmission(DISPLAY_I2C_ADDRESS);
+  Wire.write(0x00); //Command stream
+  Wire.write(0x20); //Memory addressing mode
+  Wire.write(0x00); //Horizontal
+  Wire.endTransmission();
+
+  PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+  PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+  DMAC->BASEADDR.reg = (uint32_t)&dt_base_descriptor;
+  DMAC->WRBADDR.reg = (uint32_t)&dt_writeback_descriptor;
+  DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+
+  DMAC->CHID.reg = DMAC_CHID_ID(DISPLAY_DMA_CHANNEL);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+  DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(DISPLAY_DMA_TRIGGER) | DMAC_CHCTRLB_TRIGACT_BEAT;
+  DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL | DMAC_CHINTENSET_TERR;
+  NVIC_EnableIRQ(DMAC_IRQn);
+#endif
+}
+
+#ifdef DISPLAY_DMA
+//Whether the SERCOM reports a failed transaction: a NACK from the panel or a bus error.
+bool dt_error(){
+  const uint16_t errors = SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST | SERCOM_I2CM_STATUS_LENERR;
+  if(DISPLAY_SERCOM->I2CM.STATUS.reg & errors){
+    return true;
+  }
+  return (DISPLAY_SERCOM->I2CM.INTFLAG.reg & SERCOM_I2CM_INTFLAG_MB) && DISPLAY_SERCOM->I2CM.STATUS.bit.RXNACK;
+}
+
+//Stops the transaction in progress and drops the queue. Called with the DMA interrupt masked, or from it.
+void dt_abort(){
+  DMAC->CHID.reg = DMAC_CHID_ID(DISPLAY_DMA_CHANNEL);
+  DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+  while(DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE);
+  DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR;
+
+  if(DISPLAY_SERCOM->I2CM.STATUS.bit.BUSSTATE == 2){ //Still owner of the bus: issue the stop condition
+    DISPLAY_SERCOM->I2CM.CTRLB.bit.CMD = 3;
+    while(DISPLAY_SERCOM->I2CM.SYNCBUSY.bit.SYSOP);
+  }
+  //Clear the error flags and force the bus state to idle, so the next transaction can start:
+  DISPLAY_SERCOM->I2CM.STATUS.reg = SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST | SERCOM_I2CM_STATUS_LENERR |
+                                    SERCOM_I2CM_STATUS_BUSSTATE(1);
+  while(DISPLAY_SERCOM->I2CM.SYNCBUSY.bit.SYSOP);
+  DISPLAY_SERCOM->I2CM.INTFLAG.reg = SERCOM_I2CM_INTFLAG_MB | SERCOM_I2CM_INTFLAG_ERROR;
+
+  dt_pending = 0;
+  dt_active = false;
+  dt_failed = true;
+}
+
+//Starts the lowest queued page. Called from loop() context with the DMA interrupt masked, or from the DMA interrupt.
+void dt_startNextPage(){
+  if(dt_pending == 0){
+    dt_active = false;
+    return;
+  }
+  uint8_t page = __builtin_ctz(dt_pending);
+  dt_pending &= ~(1 << page);
+  dt_active = true;
+
+  //The source address of an incrementing transfer is the address after the last byte.
+  dt_base_descriptor.BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC | DMAC_BTCTRL_BLOCKACT_NOACT;
+  dt_base_descriptor.BTCNT.reg = DT_HEADER_SIZE;
+  dt_base_descriptor.SRCADDR.reg = (uint32_t)(dt_headers[page] + DT_HEADER_SIZE);
+  dt_base_descriptor.DSTADDR.reg = (uint32_t)&DISPLAY_SERCOM->I2CM.DATA.reg;
+  dt_base_descriptor.DESCADDR.reg = (uint32_t)&dt_data_descriptor;
+
+  dt_data_descriptor.BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC | DMAC_BTCTRL_BLOCKACT_INT;
+  dt_data_descriptor.BTCNT.reg = dt_length[page];
+  dt_data_descriptor.SRCADDR.reg = (uint32_t)(dt_data[page] + dt_length[page]);
+  dt_data_descriptor.DSTADDR.reg = (uint32_t)&DISPLAY_SERCOM->I2CM.DATA.reg;
+  dt_data_descriptor.DESCADDR.reg = 0;
+
+  DMAC->CHID.reg = DMAC_CHID_ID(DISPLAY_DMA_CHANNEL);
+  DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+
+  //Writing the address starts the transaction. With LENEN the peripheral counts the bytes and
+  //the DMA is triggered for each one.
+  DISPLAY_SERCOM->I2CM.ADDR.reg = SERCOM_I2CM_ADDR_ADDR(DISPLAY_I2C_ADDRESS << 1) | SERCOM_I2CM_ADDR_LENEN |
+                                  SERCOM_I2CM_ADDR_LEN(DT_HEADER_SIZE + dt_length[page]);
+  while(DISPLAY_SERCOM->I2CM.SYNCBUSY.bit.SYSOP);
+}
+
+void DMAC_Handler(){
+  DMAC->CHID.reg = DMAC_CHID_ID(DISPLAY_DMA_CHANNEL);
+  bool transfer_error = DMAC->CHINTFLAG.bit.TERR;
+  DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR;
+
+  //The DMA is done when the last byte is handed to the peripheral. Wait for it to go out
+  //(at most one byte time) and end the transaction before starting the next one.
+  while(!(DISPLAY_SERCOM->I2CM.INTFLAG.reg & (SERCOM_I2CM_INTFLAG_MB | SERCOM_I2CM_INTFLAG_ERROR)));
+  if(transfer_error || dt_error()){
+    dt_abort();
+    return;
+  }
+  if(DISPLAY_SERCOM->I2CM.STATUS.bit.BUSSTATE == 2){ //Still owner of the bus: issue the stop condition
+    DISPLAY_SERCOM->I2CM.CTRLB.bit.CMD = 3;
+    while(DISPLAY_SERCOM->I2CM.SYNCBUSY.bit.SYSOP);
+  }
+  dt_startNextPage();
+}
+#endif
+
+//Queues a write of len bytes to columns x..x+len-1 of a page. The data must not change until
+//the write has completed (dt_busy() returns false). Call dt_start() once all pages are queued.
+void dt_queuePage(uint8_t page, uint8_t x, uint8_t len, const uint8_t* data){
+  energyI2cBytes(1 + DT_HEADER_SIZE + len);
+#ifdef DISPLAY_DMA
+  uint8_t* header = dt_headers[page];
+  //Each command byte is preceded by a control byte with Co = 1; 0x40 starts the data stream.
+  header[0] = 0x80; header[1] = 0x21; //Column window
+  header[2] = 0x80; header[3] = x;
+  header[4] = 0x80; header[5] = x + len - 1;
+  header[6] = 0x80; header[7] = 0x22; //Page window
+  header[8] = 0x80; header[9] = page;
+  header[10] = 0x80; header[11] = page;
+  header[12] = 0x40;
+  dt_data[page] = data;
+  dt_length[page] = len;
+  NVIC_DisableIRQ(DMAC_IRQn);
+  dt_pending |= 1 << page;
+  NVIC_EnableIRQ(DMAC_IRQn);
+#else
+  ssd1306_drawBuffer(x, page, len, 8, data);
+#endif
+}
+
+//Starts sending the queued pages in the background.
+void dt_start(){
+#ifdef DISPLAY_DMA
+  NVIC_DisableIRQ(DMAC_IRQn);
+  if(!dt_active){
+    dt_startNextPage();
+  }
+  NVIC_EnableIRQ(DMAC_IRQn);
+#endif
+}
+
+bool dt_busy(){
+  return dt_active || dt_pending != 0;
+}
+
+//Idles the CPU until every queued page has been sent, or the transfer failed. The DMA interrupt
+//wakes it, and the SysTick interrupt every millisecond. A NACK stops the SERCOM from requesting
+//more bytes, so the DMA interrupt never comes; the errors are checked here instead.
+void dt_wait(){
+#ifdef DISPLAY_DMA
+  uint32_t started = millis();
+  while(dt_busy()){
+    NVIC_DisableIRQ(DMAC_IRQn);
+    if((dt_active && dt_error()) || millis() - started >= DT_TIMEOUT){
+      dt_abort();
+    }
+    NVIC_EnableIRQ(DMAC_IRQn);
+    if(dt_busy()){
+      LowPower.idle();
+    }
+  }
+#endif
+}
+
+//Returns whether a write failed since the last call, in which case the panel shows an unknown
+//mix of old and new pages.
+bool dt_takeFailure(){
+#ifdef DISPLAY_DMA
+  NVIC_DisableIRQ(DMAC_IRQn);
+  bool failed = dt_failed;
+  dt_failed = false;
+  NVIC_EnableIRQ(DMAC_IRQn);
+  return failed;
+#else
+  return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef ENERGY_MONITOR_H
+#define ENERGY_MONITOR_H
+
+/*
+ * Energy accounting. The firmware measures how long each power consumer is active (processor
+ * running or idle, deep sleep, display, servo) and how many bytes go over I2C, and multiplies
+ * these by typical currents to estimate the charge taken from the battery. The totals cover the
+ * time since power-on, and are shown on the diagnostics screen and can be dumped over serial.
+ *
+ * Deep sleep stops millis(), so sleep is timed with the DS1302 instead (in whole seconds).
+ */
+
+//Typical currents, used to turn the measured times into charge:
+#define ACTIVE_CURRENT_UA 6000 //SAMD21 running at 48 MHz
+#define IDLE_CURRENT_UA 2500 //SAMD21 in idle between interrupts
+#define SLEEP_CURRENT_UA 1400 //The whole box in deep sleep (about one month on the AAA pack)
+#define DISPLAY_CURRENT_UA 8000 //SSD1306 switched on, showing a menu
+#define SERVO_CURRENT_UA 150000 //Servo powered, averaged over a move
+#define I2C_CHARGE_PER_BYTE 8 //nC: pull-up current while the lines are low, per byte at 400 kHz
+#define BATTERY_CAPACITY_MAH 1000 //Three AAA alkaline cells in series
+
+#define BATTERY_SAMPLE_PERIOD 600 //Seconds between battery voltage samples
+#define BATTERY_DIVIDER 2 //The pack is above the 3.3 V ADC range, so it is measured through a 1:2 divider
+
+struct EnergyStats{
+  uint32_t awake_ms; //Processor running or idle
+  uint64_t idle_us; //Part of awake_ms spent in LowPower.idle()
+  uint32_t sleep_s; //Deep sleep
+  uint32_t display_ms; //Display switched on
+  uint32_t servo_ms; //SERVO_TRANSISTOR_PIN high
+  uint32_t i2c_bytes; //Bytes sent to the display, including addressing and window commands
+  uint16_t battery_mv; //Last battery sample (0 if there is no battery input)
+};
+
+static EnergyStats energy;
+static unsigned long awake_since = 0; //millis() at power-on or the last wake
+static unsigned long display_on_since = 0;
+static unsigned long servo_on_since = 0;
+static bool display_on = false;
+static bool servo_on = false;
+static uint32_t sleep_started_at = 0; //UNIX time at which the box went to sleep
+#ifdef BATTERY_SENSE_PIN
+static uint32_t battery_sampled_at = 0;
+static bool battery_sampled = false;
+#endif
+
+//Takes one ADC sample of the battery voltage, at most once per BATTERY_SAMPLE_PERIOD.
+void sampleBattery(bool force = false){
+#ifdef BATTERY_SENSE_PIN
+  uint32_t now = currentTimestamp();
+  if(force || !battery_sampled || now - battery_sampled_at >= BATTERY_SAMPLE_PERIOD){
+    analogReadResolution(12);
+    energy.battery_mv = (uint32_t)analogRead(BATTERY_SENSE_PIN) * 3300 * BATTERY_DIVIDER / 4095;
+    battery_sampled_at = now;
+    battery_sampled = true;
+  }
+#else
+  (void)force;
+#endif
+}
+
+//Call once in setup(), after the display has been switched on. The battery is sampled separately,
+//once the first screen is up.
+void energyInit(){
+  memset(&energy, 0, sizeof(energy));
+  awake_since = millis();
+  display_on_since = millis();
+  display_on = true;
+}
+
+//Folds the periods that are still running into the totals, so they are up to date.
+void energyUpdate(){
+  unsigned long now = millis();
+  energy.awake_ms += now - awake_since;
+  awake_since = now;
+  if(display_on){
+    energy.display_ms += now - display_on_since;
+    display_on_since = now;
+  }
+  if(servo_on){
+    energy.servo_ms += now - servo_on_since;
+    servo_on_since = now;
+  }
+}
+
+void energyDisplayPower(bool on){
+  if(on != display_on){
+    energyUpdate();
+    display_on = on;
+    display_on_since = millis();
+  }
+}
+
+void energyServoPower(bool on){
+  if(on != servo_on){
+    energyUpdate();
+    servo_on = on;
+    servo_on_since = millis();
+  }
+}
+
+void energyI2cBytes(uint16_t bytes){
+  energy.i2c_bytes += bytes;
+}
+
+//Call right before and right after LowPower.deepSleep(). The clock reading must have been
+//invalidated before energyWake(), as millis() did not advance during the sleep.
+void energySleep(){
+  energyUpdate();
+  sleep_started_at = currentTimestamp();
+}
+
+void energyWake(){
+  uint32_t now = currentTimestamp();
+  if(now > sleep_started_at){ //Not if the clock was stopped or set back
+    energy.sleep_s += now - sleep_started_at;
+  }
+  awake_since = millis();
+  if(display_on){
+    display_on_since = millis();
+  }
+  sampleBattery();
+}
+
+//Estimated charge taken from the battery since power-on, in µAh:
+uint32_t energyUsedUah(){
+  uint32_t idle_ms = energy.idle_us / 1000;
+  uint32_t active_ms = energy.awake_ms > idle_ms ? energy.awake_ms - idle_ms : 0;
+  uint64_t charge = (uint64_t)active_ms * ACTIVE_CURRENT_UA //µA·ms, i.e. nC
+                  + (uint64_t)idle_ms * IDLE_CURRENT_UA
+                  + (uint64_t)energy.sleep_s * 1000 * SLEEP_CURRENT_UA
+                  + (uint64_t)energy.display_ms * DISPLAY_CURRENT_UA
+                  + (uint64_t)energy.servo_ms * SERVO_CURRENT_UA
+                  + (uint64_t)energy.i2c_bytes * I2C_CHARGE_PER_BYTE;
+  return charge / 3600000;
+}
+
+//Estimated days until the battery is empty at the average current since power-on:
+uint32_t energyRemainingDays(){
+  uint64_t used = energyUsedUah();
+  uint64_t capacity = (uint64_t)BATTERY_CAPACITY_MAH * 1000;
+  uint64_t elapsed_s = energy.awake_ms / 1000 + energy.sleep_s;
+  if(used == 0 || elapsed_s == 0 || used >= capacity){
+    return 0;
+  }
+  return (capacity - used) * elapsed_s / used / 86400;
+}
+
+//Writes the totals to the serial port as name=value lines.
+void printEnergyReport(){
+  if(!Serial){
+    return;
+  }
+  energyUpdate();
+  Serial.print("awake_ms="); Serial.println((unsigned long)energy.awake_ms);
+  Serial.print("idle_ms="); Serial.println((unsigned long)(energy.idle_us / 1000));
+  Serial.print("sleep_s="); Serial.println((unsigned long)energy.sleep_s);
+  Serial.print("display_ms="); Serial.println((unsigned long)energy.display_ms);
+  Serial.print("servo_ms="); Serial.println((unsigned long)energy.servo_ms);
+  Serial.print("i2c_bytes="); Serial.println((unsigned long)energy.i2c_bytes);
+  Serial.print("battery_mv="); Serial.println((unsigned long)energy.battery_mv);
+  Serial.print("used_uah="); Serial.println((unsigned long)energyUsedUah());
+  Serial.print("remaining_days="); Serial.println((unsigned long)energyRemainingDays());
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <atomic>
+
+/*
+ * A ring buffer of timestamped events, for finding out on the box itself how long a press takes
+ * to reach the screen, how many presses the debouncing drops, and what holds up the main loop.
+ * Recording an event stores eight bytes in RAM; once the buffer is full, the oldest events are
+ * overwritten. The buffer is dumped over serial from the diagnostics screen, and
+ * host/tools/decode_trace.py turns the dump into an event list and latency histograms.
+ *
+ * Events are recorded from the main loop with trace() and from the button interrupts with
+ * traceFromInterrupt(). The interrupts never preempt each other (see InputEvents.h), so only
+ * trace() has to keep them out while it takes a slot. It must not be called with interrupts
+ * disabled, as it enables them again. An entry is written before trace_count counts it, with
+ * signal fences keeping the compiler from reordering the two (as with the event queue).
+ *
+ * Dump format: a "trace=<count>" line, followed by count raw entries, oldest first, and a newline.
+ */
+
+//Event types, with what the two arguments hold:
+#define TRACE_ISR 1 //A button interrupt: the event type
+#define TRACE_DEBOUNCE_REJECT 2 //A press dropped by the debouncing: the event type
+#define TRACE_HANDLER_START 3 //The event type (TRACE_TICK for the tick) and the state ID
+#define TRACE_HANDLER_END 4 //Same as TRACE_HANDLER_START
+#define TRACE_TRANSFER 5 //The state IDs transferred from and to
+#define TRACE_FLASH_WRITE 6 //TRACE_FLASH_RECORD or TRACE_FLASH_AUDIT, and 1 for a row erase or 0 for a write
+#define TRACE_SERVO_ON 7
+#define TRACE_SERVO_OFF 8
+#define TRACE_SLEEP 9
+#define TRACE_WAKE 10
+#define TRACE_FRAME 11 //A flush started sending changes: the number of pages sent
+
+#define TRACE_TICK 0xFF //Handler argument for the state's tick function
+#define TRACE_FLASH_RECORD 0 //PersistentState.h
+#define TRACE_FLASH_AUDIT 1 //AuditLog.h
+
+#define TRACE_SIZE 128 //Entries (1 KB of RAM). Must be a power of two
+
+struct TraceEntry{
+  uint32_t time; //micros()
+  uint8_t type;
+  uint8_t a;
+  uint8_t b;
+  uint8_t unused;
+};
+
+static_assert(sizeof(TraceEntry) == 8, "The dump format has 8-byte entries");
+
+static TraceEntry trace_buffer[TRACE_SIZE];
+static volatile uint32_t trace_count = 0; //Events recorded since power-on; the next one goes to slot trace_count % TRACE_SIZE
+
+void traceRecord(uint32_t slot, uint8_t type, uint8_t a, uint8_t b){
+  TraceEntry& entry = trace_buffer[slot & (TRACE_SIZE - 1)];
+  entry.time = micros();
+  entry.type = type;
+  entry.a = a;
+  entry.b = b;
+}
+
+//Called from the main loop:
+void trace(uint8_t type, uint8_t a = 0, uint8_t b = 0){
+  noInterrupts();
+  uint32_t slot = trace_count++;
+  traceRecord(slot, type, a, b);
+  interrupts();
+}
+
+//Called from interrupt context:
+void traceFromInterrupt(uint8_t type, uint8_t a = 0, uint8_t b = 0){
+  uint32_t slot = trace_count;
+  traceRecord(slot, type, a, b);
+  std::atomic_signal_fence(std::memory_order_release);
+  trace_count = slot + 1; //Count the entry only after it has been written
+}
+
+//Writes the buffer to the serial port (see the format above).
+void printTrace(){
+  if(!Serial){
+    return;
+  }
+  uint32_t end = trace_count;
+  std::atomic_signal_fence(std::memory_order_acquire); //Read only entries that were counted
+  uint32_t count = min(end, (uint32_t)TRACE_SIZE);
+  Serial.print("trace=");
+  Serial.println((unsigned long)count);
+  for(uint32_t i = end - count; i != end; i++){
+    Serial.write((const uint8_t*)&trace_buffer[i & (TRACE_SIZE - 1)], sizeof(TraceEntry));
+  }
+  Serial.println();
+}
+
+#endif
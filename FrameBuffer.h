@@ -0,0 +1,181 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+/*
+ * A RAM copy of the 128x64 display that the states draw into instead of the display itself.
+ * The memory layout matches the SSD1306: 8 pages (rows of 8 pixels), each 128 columns of one
+ * byte, with the least significant bit at the top.
+ *
+ * Drawing only touches RAM and records which columns of each page were touched. fb_flush()
+ * compares the touched columns against a second copy holding what the panel currently shows
+ * and sends only the bytes that actually changed. Clearing and redrawing a whole screen to
+ * change one digit therefore costs a few dozen I2C bytes instead of more than 1 KB.
+ */
+
+#define SCREEN_WIDTH 128
+#define SCREEN_PAGES 8
+
+//Sending the pages to the panel:
+#include "DisplayTransport.h"
+
+static uint8_t frame_buffer[SCREEN_PAGES][SCREEN_WIDTH]; //What the states have drawn
+static uint8_t panel_buffer[SCREEN_PAGES][SCREEN_WIDTH]; //What the display currently shows
+static uint8_t dirty_start[SCREEN_PAGES]; //First touched column of each page since the last flush
+static uint8_t dirty_end[SCREEN_PAGES]; //One past the last touched column (equal to dirty_start if untouched)
+
+static const uint8_t* fb_font = nullptr; //Fixed font in the ssd1306 library format
+static bool fb_inverted = false;
+static bool panel_unknown = false; //Whether panel_buffer does not reflect the display yet (until the first flush)
+
+void markDirty(uint8_t page, uint8_t x_start, uint8_t x_end){
+  if(dirty_start[page] == dirty_end[page]){
+    dirty_start[page] = x_start;
+    dirty_end[page] = x_end;
+  }else{
+    if(x_start < dirty_start[page]) dirty_start[page] = x_start;
+    if(x_end > dirty_end[page]) dirty_end[page] = x_end;
+  }
+}
+
+//Clears both buffers. Call once after initializing the display.
+//The display RAM holds random data after power-on. Rather than clearing it with a write of its
+//own, the first flush sends every page in full, so the first screen is the only write at start-up.
+void fb_init(){
+  memset(frame_buffer, 0, sizeof(frame_buffer));
+  memset(panel_buffer, 0, sizeof(panel_buffer));
+  memset(dirty_start, 0, sizeof(dirty_start));
+  memset(dirty_end, 0, sizeof(dirty_end));
+  panel_unknown = true;
+}
+
+void fb_clearScreen(){
+  memset(frame_buffer, 0, sizeof(frame_buffer));
+  for(uint8_t page = 0; page < SCREEN_PAGES; page++){
+    markDirty(page, 0, SCREEN_WIDTH);
+  }
+}
+
+//Clears a block. y is given in pages and h in pixels, as with ssd1306_clearBlock.
+void fb_clearBlock(uint8_t x, uint8_t y, uint8_t w, uint8_t h){
+  if(x >= SCREEN_WIDTH) return;
+  if(x + w > SCREEN_WIDTH) w = SCREEN_WIDTH - x;
+  for(uint8_t page = y; page < y + h/8 && page < SCREEN_PAGES; page++){
+    memset(&frame_buffer[page][x], 0, w);
+    markDirty(page, x, x + w);
+  }
+}
+
+void fb_setFixedFont(const uint8_t* font){
+  fb_font = font;
+}
+
+void fb_negativeMode(){
+  fb_inverted = true;
+}
+
+void fb_positiveMode(){
+  fb_inverted = false;
+}
+
+//Width in pixels of a string in the current font:
+uint8_t fb_getTextWidth(const char* text){
+  return strlen(text) * pgm_read_byte(&fb_font[1]);
+}
+
+//Prints text in the current font. y is given in pixels and must be a multiple of 8.
+//Returns the column after the last character.
+uint8_t fb_printFixed(uint8_t x, uint8_t y, const char* text, EFontStyle style){
+  const uint8_t width = pgm_read_byte(&fb_font[1]);
+  const uint8_t pages = pgm_read_byte(&fb_font[2]) / 8;
+  const uint8_t first_char = pgm_read_byte(&fb_font[3]);
+  const uint8_t* glyphs = fb_font + 4;
+  const uint8_t x_start = x;
+
+  for(uint8_t p = 0; p < pages; p++){
+    uint8_t page = y/8 + p;
+    if(page >= SCREEN_PAGES) break;
+    uint8_t column = x_start;
+    uint8_t last_data = 0; //For STYLE_BOLD: each column is OR-ed with the previous one
+    for(const char* c = text; *c && column < SCREEN_WIDTH; c++){
+      const uint8_t* glyph = glyphs + (uint16_t)((uint8_t)*c - first_char) * width * pages + p * width;
+      for(uint8_t i = 0; i < width && column < SCREEN_WIDTH; i++, column++){
+        uint8_t data = pgm_read_byte(&glyph[i]);
+        if(style == STYLE_BOLD){
+          uint8_t bold = data | last_data;
+          last_data = data;
+          data = bold;
+        }
+        frame_buffer[page][column] = fb_inverted ? ~data : data;
+      }
+    }
+    if(column > x_start){
+      markDirty(page, x_start, column);
+    }
+  }
+  return x_start + strlen(text) * width;
+}
+
+//Draws a PROGMEM bitmap. y is given in pages and h in pixels, as with ssd1306_drawBitmap.
+void fb_drawBitmap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* bitmap){
+  if(x >= SCREEN_WIDTH) return;
+  uint8_t visible_w = x + w > SCREEN_WIDTH ? SCREEN_WIDTH - x : w;
+  for(uint8_t p = 0; p < h/8 && y + p < SCREEN_PAGES; p++){
+    for(uint8_t i = 0; i < visible_w; i++){
+      uint8_t data = pgm_read_byte(&bitmap[p*w + i]);
+      frame_buffer[y + p][x + i] = fb_inverted ? ~data : data;
+    }
+    markDirty(y + p, x, x + visible_w);
+  }
+}
+
+//Sends the bytes that differ from what the panel shows, as one write per page covering the first
+//to the last changed column. The writes go out in the background from panel_buffer, so the
+//drawing functions can keep using frame_buffer meanwhile.
+void fb_flush(){
+  dt_wait(); //panel_buffer is still being read by the previous flush
+  if(dt_takeFailure()){
+    panel_unknown = true; //Send every page again
+  }
+  uint8_t pages_sent = 0;
+  for(uint8_t page = 0; page < SCREEN_PAGES; page++){
+    uint8_t start = dirty_start[page];
+    uint8_t end = dirty_end[page];
+    dirty_start[page] = dirty_end[page] = 0;
+    if(panel_unknown){
+      start = 0;
+      end = SCREEN_WIDTH;
+      memcpy(panel_buffer[page], frame_buffer[page], SCREEN_WIDTH);
+      dt_queuePage(page, start, end - start, panel_buffer[page]);
+      pages_sent++;
+      continue;
+    }
+
+    while(start < end && frame_buffer[page][start] == panel_buffer[page][start]) start++; //Skip unchanged bytes
+    while(end > start && frame_buffer[page][end - 1] == panel_buffer[page][end - 1]) end--;
+    if(start == end) continue;
+
+    memcpy(&panel_buffer[page][start], &frame_buffer[page][start], end - start);
+    dt_queuePage(page, start, end - start, &panel_buffer[page][start]);
+    pages_sent++;
+  }
+  panel_unknown = false;
+  if(pages_sent > 0){
+    trace(TRACE_FRAME, pages_sent);
+  }
+  dt_start();
+}
+
+//Turn the panel on or off. These go through the display library, so queued writes are finished first.
+void fb_displayOn(){
+  dt_wait();
+  ssd1306_displayOn();
+  energyDisplayPower(true);
+}
+
+void fb_displayOff(){
+  dt_wait();
+  ssd1306_displayOff();
+  energyDisplayPower(false);
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef IDLE_TIMER_H
+#define IDLE_TIMER_H
+
+/*
+ * Idles the CPU until the main loop's next deadline. LowPower.idle() stops the CPU until the next
+ * interrupt, and on its own the SysTick interrupt behind millis() ends the idle every millisecond,
+ * whatever the deadline. On the SAMD21, idleFor() switches SysTick off for the idle and arms TC5
+ * to wake the CPU at the deadline instead. TC5 also measures how long the idle lasted, and
+ * idleCatchUp() moves millis() on by that time (running the core's SysTick handler once per
+ * millisecond) before switching SysTick back on. The part of a millisecond left over is carried
+ * into the next idle, so millis() does not lose time.
+ *
+ * A button or the DMA interrupt ends the idle early. The button interrupts call idleCatchUp()
+ * before they read millis(), so their timestamps are right.
+ *
+ * On other targets (the host simulation) the CPU is idled until the next SysTick.
+ */
+
+#define IDLE_MAX_MS 1000 //Longest single idle. TC5 counts up to 1398 ms
+
+#if defined(__SAMD21G18A__)
+
+#define IDLE_TIMER_HZ 46875 //48 MHz / 1024
+
+extern "C" void SysTick_DefaultHandler(void); //Advances millis() by one (see delay.c in the core)
+
+static volatile bool idle_timing = false; //SysTick is off and TC5 is counting the idle
+static uint16_t idle_timer_top = 0; //TC5 count at which the idle ends
+static uint32_t idle_remainder = 0; //Part of a millisecond counted but not yet added to millis(), in thousandths of a TC5 count
+static bool idle_timer_ready = false;
+
+void idleTimerInit(){
+  //TC4 and TC5 share a generic clock, which the servo library sets up the same way for TC4.
+  GCLK->CLKCTRL.reg = GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID_TC4_TC5;
+  while(GCLK->STATUS.bit.SYNCBUSY);
+  PM->APBCMASK.reg |= PM_APBCMASK_TC5;
+  TC5->COUNT16.CTRLA.reg = TC_CTRLA_SWRST;
+  while(TC5->COUNT16.CTRLA.bit.SWRST);
+  //Counts from 0 to CC0, then wraps to 0 and stops:
+  TC5->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV1024;
+  TC5->COUNT16.CTRLBSET.reg = TC_CTRLBSET_ONESHOT;
+  while(TC5->COUNT16.STATUS.bit.SYNCBUSY);
+  TC5->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
+  while(TC5->COUNT16.STATUS.bit.SYNCBUSY);
+  TC5->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_STOP;
+  while(TC5->COUNT16.STATUS.bit.SYNCBUSY);
+  TC5->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+  NVIC_EnableIRQ(TC5_IRQn);
+  idle_timer_ready = true;
+}
+
+//Only wakes the CPU. The OVF flag, which is left set, tells idleCatchUp() that the idle ran out.
+void TC5_Handler(){
+  TC5->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+}
+
+//Ends the timed idle: stops TC5, adds the time it counted to millis() and switches SysTick back
+//on. Does nothing if no timed idle is running. Called with interrupts disabled, or from a button interrupt.
+void idleCatchUp(){
+  if(!idle_timing){
+    return;
+  }
+  idle_timing = false;
+  TC5->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_STOP;
+  while(TC5->COUNT16.STATUS.bit.SYNCBUSY);
+  uint16_t counted;
+  if(TC5->COUNT16.INTFLAG.bit.OVF){ //Ran to the end and wrapped to 0
+    counted = idle_timer_top;
+  }else{
+    TC5->COUNT16.READREQ.reg = TC_READREQ_RREQ | TC_READREQ_ADDR(TC_COUNT16_COUNT_OFFSET);
+    while(TC5->COUNT16.STATUS.bit.SYNCBUSY);
+    counted = TC5->COUNT16.COUNT.reg;
+  }
+  uint32_t elapsed = idle_remainder + (uint32_t)counted * 1000;
+  idle_remainder = elapsed % IDLE_TIMER_HZ;
+  for(uint32_t ms = elapsed / IDLE_TIMER_HZ; ms > 0; ms--){
+    SysTick_DefaultHandler();
+  }
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+}
+
+//Idles the CPU for ms milliseconds (at most IDLE_MAX_MS), or until an interrupt.
+void idleFor(unsigned long ms){
+  if(!idle_timer_ready){
+    idleTimerInit();
+  }
+  if(ms > IDLE_MAX_MS){
+    ms = IDLE_MAX_MS;
+  }
+  idle_timer_top = ms * IDLE_TIMER_HZ / 1000;
+  TC5->COUNT16.CC[0].reg = idle_timer_top;
+  while(TC5->COUNT16.STATUS.bit.SYNCBUSY);
+  TC5->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0 | TC_INTFLAG_OVF;
+
+  noInterrupts();
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk; //Stops the counter too, so the current millisecond resumes where it was
+  TC5->COUNT16.CTRLBSET.reg = TC_CTRLBSET_CMD_RETRIGGER; //Starts from 0
+  while(TC5->COUNT16.STATUS.bit.SYNCBUSY);
+  idle_timing = true;
+  interrupts();
+
+  LowPower.idle();
+
+  noInterrupts();
+  idleCatchUp();
+  interrupts();
+}
+
+#else
+
+void idleCatchUp(){}
+
+void idleFor(unsigned long ms){
+  (void)ms;
+  LowPower.idle(); //The next SysTick wakes the CPU
+}
+
+#endif
+
+#endif
@@ -15,5 +15,23 @@ const uint8_t DownArrow [] PROGMEM = {
 };
 
 
+/*
+ * Digit atlas for the combination and duration screens.
+ * The glyphs of courier_new_font11x16_digits are already stored pre-rendered and page by page, in
+ * the same layout as the images above, so the atlas points straight into the font instead of
+ * keeping a second copy. Drawing a digit is then a plain bitmap blit; the selected digit is drawn
+ * inverted by the blit itself (see fb_negativeMode), so no inverted copies are needed either.
+ */
+#define DIGIT_WIDTH 11
+#define DIGIT_HEIGHT 16
+#define DIGIT_FIRST_CHAR ',' //The first character of courier_new_font11x16_digits
+#define DIGIT_GLYPH(c) (courier_new_font11x16_digits + 4 + ((c) - DIGIT_FIRST_CHAR) * DIGIT_WIDTH * DIGIT_HEIGHT/8)
+#define COLON_GLYPH 10
+
+const uint8_t* const DigitGlyphs[] = {
+  DIGIT_GLYPH('0'), DIGIT_GLYPH('1'), DIGIT_GLYPH('2'), DIGIT_GLYPH('3'), DIGIT_GLYPH('4'),
+  DIGIT_GLYPH('5'), DIGIT_GLYPH('6'), DIGIT_GLYPH('7'), DIGIT_GLYPH('8'), DIGIT_GLYPH('9'),
+  DIGIT_GLYPH(':'),
+};
 
 #endif
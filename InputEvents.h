@@ -0,0 +1,118 @@
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include <atomic>
+
+//Button events, queued by the interrupt functions and handled by the main loop:
+#define UP_BUTTON_EVENT 0
+#define DOWN_BUTTON_EVENT 1
+#define LEFT_BUTTON_EVENT 2
+#define RIGHT_BUTTON_EVENT 3
+#define WAKE_EVENT 4 //The up button woke the box from sleep
+
+#define EVENT_QUEUE_SIZE 16 //Must be a power of two
+
+struct InputEvent{
+  uint32_t time; //millis() when the interrupt fired
+  uint8_t type;
+};
+
+/*
+ * Single-producer/single-consumer ring buffer.
+ * The producer is the EIC interrupt (all button pins share one interrupt vector, so the
+ * button interrupts never preempt each other) and the consumer is loop(). The producer only
+ * writes event_head and the consumer only writes event_tail, so no locking is needed.
+ * One slot is left empty to tell a full queue from an empty one.
+ *
+ * event_queue is not volatile, so the compiler could move its accesses across those of the
+ * indexes. The signal fences keep each slot's accesses on the right side of the index that hands
+ * the slot over. (The Cortex-M0+ does not reorder memory accesses itself.)
+ */
+static InputEvent event_queue[EVENT_QUEUE_SIZE];
+static volatile uint8_t event_head = 0; //Next slot to write (interrupt side)
+static volatile uint8_t event_tail = 0; //Next slot to read (loop side)
+
+//Called from interrupt context. Drops the event if the queue is full.
+void pushEvent(uint8_t type, uint32_t time){
+  uint8_t head = event_head;
+  uint8_t next = (head + 1) & (EVENT_QUEUE_SIZE - 1);
+  if(next == event_tail){
+    return;
+  }
+  std::atomic_signal_fence(std::memory_order_acquire); //The slot is free once event_tail has moved past it
+  event_queue[head].time = time;
+  event_queue[head].type = type;
+  std::atomic_signal_fence(std::memory_order_release);
+  event_head = next; //Publish the event only after it has been written
+}
+
+//Called from the main loop. Returns false if there is no event waiting.
+bool popEvent(InputEvent& event){
+  uint8_t tail = event_tail;
+  if(tail == event_head){
+    return false;
+  }
+  std::atomic_signal_fence(std::memory_order_acquire); //Read the event only after event_head said it is there
+  event.time = event_queue[tail].time;
+  event.type = event_queue[tail].type;
+  std::atomic_signal_fence(std::memory_order_release);
+  event_tail = (tail + 1) & (EVENT_QUEUE_SIZE - 1); //Free the slot only after it has been read
+  return true;
+}
+
+bool hasPendingEvents(){
+  return event_tail != event_head;
+}
+
+/*
+ * Auto-repeat. The interrupts only see a button going down, so a held up or down button is
+ * noticed with a timer: REPEAT_DELAY after the press, and then at intervals that are
+ * REPEAT_ACCELERATION percent of the previous one down to REPEAT_MIN_INTERVAL, the press is
+ * repeated for as long as the pin stays high. Repeats that fall due in one pass of the loop
+ * (see runTimers()) are handled before the screen is flushed, so a burst costs one redraw.
+ */
+#define REPEAT_DELAY 400 //How long a button must be held before it repeats
+#define REPEAT_START_INTERVAL 200
+#define REPEAT_MIN_INTERVAL 40
+#define REPEAT_ACCELERATION 80
+
+void dispatchEvent(const InputEvent& event); //Defined in States.h
+void repeatTimeout();
+
+static Timer repeat_timer = {repeatTimeout};
+static uint8_t repeat_type = UP_BUTTON_EVENT; //The event being repeated
+static uint8_t repeat_pin = 0;
+static uint16_t repeat_interval = REPEAT_START_INTERVAL;
+
+void cancelRepeat(){
+  timerStop(repeat_timer);
+}
+
+//Called for every press taken from the queue. Only the up and down buttons repeat.
+void startRepeat(const InputEvent& event){
+  if(event.type == UP_BUTTON_EVENT){
+    repeat_pin = UP_BUTTON_PIN;
+  }else if(event.type == DOWN_BUTTON_EVENT){
+    repeat_pin = DOWN_BUTTON_PIN;
+  }else{
+    cancelRepeat();
+    return;
+  }
+  repeat_type = event.type;
+  repeat_interval = REPEAT_START_INTERVAL;
+  timerStart(repeat_timer, REPEAT_DELAY);
+}
+
+void repeatTimeout(){
+  if(digitalRead(repeat_pin) == LOW){ //Released
+    return;
+  }
+  InputEvent event;
+  event.type = repeat_type;
+  event.time = repeat_timer.due;
+  timerAdvance(repeat_timer, repeat_interval); //Before the handler, which may cancel the repeat
+  repeat_interval = max(REPEAT_MIN_INTERVAL, repeat_interval * REPEAT_ACCELERATION / 100);
+  dispatchEvent(event);
+}
+
+#endif
@@ -4,8 +4,6 @@
 #include <Servo.h> //https://www.arduino.cc/reference/en/libraries/servo/
 #include <FlashStorage.h> //https://github.com/cmaglie/FlashStorage
 #include <DS1302.h> //https://www.velleman.eu/support/downloads/?code=VMA301
-#include <timestamp32bits.h> //https://github.com/kosme/timestamp32bits
-#include <RTClib.h> //https://github.com/adafruit/RTClib
 
 //Pins for the buttons:
 #define UP_BUTTON_PIN 1
@@ -22,6 +20,14 @@
 #define CLOCK_IO_PIN  9  // Input/Output
 #define CLOCK_CLOCK_PIN 8  // Serial Clock
 
+//Optional battery voltage input (through a 1:2 divider). Every pin of the XIAO is in use on the
+//stock board, so battery sampling is only compiled in if a pin is freed up and defined here.
+//#define BATTERY_SENSE_PIN A0
+
+//Unlock a time lock at its expiry by itself, sleeping until then on the SAMD21's RTC (see AlarmSleep.h).
+//Only useful if the box is left switched on while it is time-locked.
+//#define AUTO_UNLOCK
+
 
 //Internal constants:
 #define COMBO_LENGTH 6 //The current implementation supports combinations of up to 10 digits
@@ -29,7 +35,6 @@
 #define UNLOCKED_POSITION 180 //The servo angle for the unlocked position
 #define LOCKED_POSITION 100  //The servo angle for the locked position
 
-#define SERVO_WAIT_TIME 2000 //How long the servos are enabled before they are disabled again with the transistor
 #define SLEEP_TIMEOUT 10000 //How long the device stays awake since last input
 #define TICK_PERIOD 1000 //The amount of time between ticks
 
@@ -40,77 +45,105 @@
 DS1302 rtc(CLOCK_ENABLE_PIN, CLOCK_IO_PIN, CLOCK_CLOCK_PIN);
 
 Servo servo;
-static unsigned long lastServoActuation = 0; //The last time the servo was activated (for servo timeout)
-static unsigned long lastTick = 0; //The last time the current state's tick function was called
-
-void move_servo(const int servo_pos){
-  lastServoActuation = millis();
-  digitalWrite(SERVO_TRANSISTOR_PIN, HIGH); //Enable the servo transistor
-  servo.attach(SERVO_PIN);
-  servo.write(servo_pos);
-  //The deactivation of the servo is handled in the main loop
-}
 
 #include "Images.h"
-#include "ScreenCommands.h"
+#include "TextBuffer.h"
+#include "BootProfile.h"
+#include "EventTrace.h"
+#include "CivilTime.h"
 #include "ClockCommands.h"
+#include "EnergyMonitor.h"
+#include "AlarmSleep.h"
+#include "FrameBuffer.h"
+#include "ScreenCommands.h"
+#include "ScreenText.h"
+#include "ComboCodec.h"
+#include "TimerService.h"
+#include "IdleTimer.h"
+#include "InputEvents.h"
+
+#include "ServoDriver.h"
+
 #include "States.h"
 
 void setup() {
+  bootStart();
   pinMode(UP_BUTTON_PIN, INPUT_PULLDOWN);
   pinMode(RIGHT_BUTTON_PIN, INPUT_PULLDOWN);
   pinMode(DOWN_BUTTON_PIN, INPUT_PULLDOWN);
   pinMode(LEFT_BUTTON_PIN, INPUT_PULLDOWN);
   pinMode(SERVO_TRANSISTOR_PIN, OUTPUT);
 
-  //Initialize the forward declarations from States.h
-  UnlockedScreen = &__UnlockedScreen;
-  SetCombo = &__SetCombo;
-  LockedScreen = &__LockedScreen;
-  SetDuration = &__SetDuration;
-  TimeLockedScreen = &__TimeLockedScreen;
-  SleepState = &__SleepState;
-
-  //Initialize communications with the display
-  ssd1306_128x64_i2c_init();
-
-  //Read the stored data and transfer to the proper state
-  switch(stored_state_id.read()){
+  //Read the stored data and select the proper state
+  loadStoredState();
+  servoInit(stored.state_id == UNLOCKED_STATE_ID ? UNLOCKED_POSITION : LOCKED_POSITION);
+  switch(stored.state_id){
     case UNLOCKED_STATE_ID: //The box is unlocked.
-      curr_state = UnlockedScreen;
+      curr_state_id = UNLOCKED_STATE_ID;
       //move_servo(UNLOCKED_POSITION);
       break;
     case LOCKED_STATE_ID:
-      curr_state = LockedScreen;
+      curr_state_id = LOCKED_STATE_ID;
       //move_servo(LOCKED_POSITION);
       break;
     case TIME_LOCKED_STATE_ID:
-      curr_state = TimeLockedScreen;
+      curr_state_id = TIME_LOCKED_STATE_ID;
       break;
   }
-  curr_state->initialize();
+  bootMark(BOOT_STATE_LOADED);
 
-  //Finally, attach the interrupts. (Don't do this before setting the curr_state variable.)
+  //Attach the interrupts now, so presses made while the screen comes up are queued. They are handled once loop() runs.
+  //(Don't do this before setting the curr_state_id variable.)
   attachInterrupt(digitalPinToInterrupt(UP_BUTTON_PIN), upButtonInterrupt, RISING);
   attachInterrupt(digitalPinToInterrupt(DOWN_BUTTON_PIN), downButtonInterrupt, RISING);
   attachInterrupt(digitalPinToInterrupt(LEFT_BUTTON_PIN), leftButtonInterrupt, RISING);
   attachInterrupt(digitalPinToInterrupt(RIGHT_BUTTON_PIN), rightButtonInterrupt, RISING);
 
-  
+  //Initialize communications with the display
+  ssd1306_128x64_i2c_init();
+  dt_init();
+  fb_init();
+  energyInit();
+  bootMark(BOOT_DISPLAY_READY);
+
+  //Draw the first screen. fb_init() does not clear the display, so this single write replaces whatever it showed.
+  runHandler(&StateHandlers::initialize);
+  requestRedraw();
+  renderFrame();
+  fb_flush();
+  dt_wait();
+  bootMark(BOOT_FIRST_FRAME);
+
+  //Deferred until the screen is up:
+  Serial.begin(115200); //For the diagnostics report
+  sampleBattery();
+  auditInit();
+  timerStart(tick_timer, TICK_PERIOD, TICK_PERIOD);
+  timerStart(sleep_timer, SLEEP_TIMEOUT);
+  bootMark(BOOT_DONE);
 }
 
-void loop() {
-  if(servo.attached() && hasElapsed(lastServoActuation, SERVO_WAIT_TIME)){ //Turn the servo off.
-    servo.detach();
-    digitalWrite(SERVO_TRANSISTOR_PIN, LOW); //Disable the servo transistor
+//Stops the CPU until the next timer expires (the next servo step, button repeat or tick, or going to sleep).
+void idleUntilNextDeadline(){
+  //The RTC alarm used by LowPower.idle(millis) only has one second of resolution, and the deadlines are shorter
+  //than that, so the wake-up is timed by idleFor() (see IdleTimer.h). A button interrupt wakes the CPU immediately.
+  //A press queued between the check below and the idle call waits for the next SysTick, so at most one millisecond.
+  unsigned long wait = timerNextExpiry();
+  if(wait > 0 && !hasPendingEvents()){
+    unsigned long idle_start = micros();
+    idleFor(wait);
+    energy.idle_us += micros() - idle_start;
   }
-  if(hasElapsed(lastTick, TICK_PERIOD)){ //Execute the current state's tick function (For continuously updating screens, etc.)
-    noInterrupts();
-    curr_state->tick();
-    lastTick = millis();
-    interrupts();
-  }
-  if(curr_state != SleepState && hasElapsed(pressTime, SLEEP_TIMEOUT)){ //Put the device to sleep.
-    transferTo(SleepState);
+}
+
+void loop() {
+  InputEvent event;
+  while(popEvent(event)){ //Handle the button presses queued by the interrupts
+    startRepeat(event);
+    dispatchEvent(event);
   }
+  runTimers(); //Button repeats, servo steps, the current state's tick function and going to sleep
+  renderPending(); //Draw what the handlers changed
+  fb_flush(); //Send it to the display
+  idleUntilNextDeadline();
 }
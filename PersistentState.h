@@ -0,0 +1,220 @@
+#ifndef PERSISTENT_STATE_H
+#define PERSISTENT_STATE_H
+
+/*
+ * Everything the box must remember while switched off is kept in one record:
+ * the state ID, the combination and the time-lock window.
+ *
+ * The records are appended one after another to a log in a reserved flash region instead of
+ * rewriting a fixed location. A SAMD21 flash row (256 bytes) must be erased before it can be
+ * written again, so a fixed location costs one erase per write and wears out that one row.
+ * With the log, a row is only erased when the log reaches it, i.e. once every RECORDS_PER_ROW
+ * writes, and the erases are spread over all rows of the region.
+ *
+ * Each record carries a sequence number and a CRC. At start-up the valid record with the
+ * highest sequence number is loaded into the RAM copy "stored", which is what the rest of the
+ * firmware reads. A write that is interrupted by a power loss fails its CRC check, so the box
+ * falls back to the previous record.
+ *
+ * The state ID and the time-lock window change with every lock and unlock, so they are also kept
+ * in the DS1302's 31 bytes of RAM, which run on the clock battery. A ClockRamRecord is written in
+ * one burst transfer (well under a millisecond) and carries its own CRC; when it is valid at
+ * power-on it overrides these fields of the flash record. The flash record is then only written
+ * when the combination changes and when the box is locked or unlocked with the PIN, so it always
+ * knows whether the box is PIN-locked: taking out the clock battery clears the RAM, and must not
+ * open a PIN-locked box. Setting a time lock and its expiry do not touch the flash. Without the
+ * clock battery the clock stops too, and a time lock is released anyway (see
+ * TimeLockedScreen::isLocked()).
+ */
+
+#define RECORD_VERSION 1
+#define RECORD_SIZE 32 //Two records per 64-byte flash page
+#define FLASH_ROW_SIZE 256 //Smallest erasable unit
+#define RECORD_LOG_ROWS 4 //Must be at least 2, so the row being erased never holds the current record
+#define RECORDS_PER_ROW (FLASH_ROW_SIZE / RECORD_SIZE)
+#define RECORD_SLOTS (RECORD_LOG_ROWS * RECORDS_PER_ROW)
+
+struct PersistentRecord{
+  uint32_t sequence; //Incremented with every write
+  uint32_t locked_at_time; //Unix time at which the time lock was set
+  uint32_t locked_until_time; //Unix time at which the time lock expires
+  uint8_t version;
+  uint8_t state_id; //The state to return to at power-on
+  uint8_t unused[2]; //Left erased for future fields
+  uint64_t combination; //See ComboCodec.h
+  uint8_t unused_end[6];
+  uint16_t crc; //CRC of all preceding bytes
+};
+
+static_assert(sizeof(PersistentRecord) == RECORD_SIZE, "A record must fill its slot exactly");
+
+#define CLOCK_RAM_MAGIC 0x4C //Tells a record from whatever the DS1302's RAM held before
+
+struct ClockRamRecord{
+  uint32_t locked_at_time;
+  uint32_t locked_until_time;
+  uint8_t magic;
+  uint8_t state_id;
+  uint16_t crc; //CRC of all preceding bytes
+};
+
+static_assert(sizeof(ClockRamRecord) <= DS1302::kRamSize, "The record must fit in the DS1302's RAM");
+
+//Reserve the flash region for the log (same layout as the FlashStorage library uses):
+__attribute__((__aligned__(FLASH_ROW_SIZE)))
+static const uint8_t record_log[RECORD_LOG_ROWS * FLASH_ROW_SIZE] = {};
+static FlashClass record_flash(record_log, sizeof(record_log));
+
+static PersistentRecord stored; //RAM copy of the current record
+static uint16_t next_slot = 0; //The slot the next record will be written to
+static uint8_t flash_state_id = UNLOCKED_STATE_ID; //The state ID of the newest record in flash
+
+//CRC-16/CCITT. Computed bit by bit, as a table would cost 512 bytes of flash for a 30-byte record.
+uint16_t crc16(const void* data, uint8_t length){
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint16_t crc = 0xFFFF;
+  for(uint8_t i = 0; i < length; i++){
+    crc ^= (uint16_t)bytes[i] << 8;
+    for(uint8_t bit = 0; bit < 8; bit++){
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+uint16_t recordCrc(const PersistentRecord& record){
+  return crc16(&record, offsetof(PersistentRecord, crc));
+}
+
+uint16_t clockRamCrc(const ClockRamRecord& record){
+  return crc16(&record, offsetof(ClockRamRecord, crc));
+}
+
+//Writes the state ID and the time-lock window to the DS1302's RAM:
+void storeClockRam(){
+  ClockRamRecord record;
+  record.locked_at_time = stored.locked_at_time;
+  record.locked_until_time = stored.locked_until_time;
+  record.magic = CLOCK_RAM_MAGIC;
+  record.state_id = stored.state_id;
+  record.crc = clockRamCrc(record);
+  rtc.writeRamBulk((const uint8_t*)&record, sizeof(record));
+}
+
+//Overrides the fields of the RAM copy that the DS1302's RAM holds, if it holds a valid record.
+void loadClockRam(){
+  ClockRamRecord record;
+  rtc.writeProtect(false); //Allows storeClockRam() to write (the DS1302 powers up with the bit undefined)
+  rtc.readRamBulk((uint8_t*)&record, sizeof(record));
+  if(record.magic != CLOCK_RAM_MAGIC || record.crc != clockRamCrc(record)){ //Clock battery removed or flat, or never written
+    return;
+  }
+  stored.state_id = record.state_id;
+  stored.locked_at_time = record.locked_at_time;
+  stored.locked_until_time = record.locked_until_time;
+}
+
+void readSlot(uint16_t slot, PersistentRecord& record){
+  record_flash.read(&record_log[slot * RECORD_SIZE], &record, RECORD_SIZE);
+}
+
+//Slots that are neither erased nor hold a valid record (never written since upload, or hit by a
+//power loss during a write) cannot be written without erasing their row first.
+bool isSlotErased(uint16_t slot){
+  PersistentRecord record;
+  readSlot(slot, record);
+  const uint8_t* bytes = (const uint8_t*)&record;
+  for(uint8_t i = 0; i < RECORD_SIZE; i++){
+    if(bytes[i] != 0xFF){
+      return false;
+    }
+  }
+  return true;
+}
+
+//Finds the newest valid record and loads it into RAM. Called once in setup().
+void loadStoredState(){
+  bool found = false;
+  PersistentRecord record;
+  for(uint16_t slot = 0; slot < RECORD_SLOTS; slot++){
+    readSlot(slot, record);
+    if(record.version != RECORD_VERSION || record.crc != recordCrc(record)){
+      continue;
+    }
+    if(!found || record.sequence > stored.sequence){
+      stored = record;
+      next_slot = (slot + 1) % RECORD_SLOTS;
+      found = true;
+    }
+  }
+  if(!found){ //Nothing stored yet: the box starts unlocked with the combination 000000
+    memset(&stored, 0, sizeof(stored));
+    stored.state_id = UNLOCKED_STATE_ID;
+    next_slot = 0;
+  }
+  flash_state_id = stored.state_id;
+  loadClockRam();
+}
+
+//Appends the RAM copy to the log as the new current record.
+void commitStoredState(){
+  stored.sequence++;
+  stored.version = RECORD_VERSION;
+  memset(stored.unused, 0xFF, sizeof(stored.unused));
+  memset(stored.unused_end, 0xFF, sizeof(stored.unused_end));
+  stored.crc = recordCrc(stored);
+
+  uint16_t slot = next_slot;
+  bool erase_row = slot % RECORDS_PER_ROW == 0; //Entering a row that still holds records from the previous pass
+  if(!erase_row && !isSlotErased(slot)){ //Skip the rest of a damaged row
+    slot = (slot / RECORDS_PER_ROW + 1) * RECORDS_PER_ROW % RECORD_SLOTS;
+    erase_row = true;
+  }
+
+  if(erase_row){
+    trace(TRACE_FLASH_WRITE, TRACE_FLASH_RECORD, 1);
+  }
+  trace(TRACE_FLASH_WRITE, TRACE_FLASH_RECORD, 0);
+  noInterrupts();
+  if(erase_row){
+    record_flash.erase(&record_log[slot * RECORD_SIZE], FLASH_ROW_SIZE);
+  }
+  record_flash.write(&record_log[slot * RECORD_SIZE], &stored, RECORD_SIZE);
+  interrupts();
+  next_slot = (slot + 1) % RECORD_SLOTS;
+  flash_state_id = stored.state_id;
+}
+
+//Update the stored state. The DS1302's RAM is written first, so a power loss before the flash
+//write leaves the new state in the RAM, which is loaded in preference to the flash.
+void storeState(uint8_t state){
+  if(stored.state_id != state){
+    stored.state_id = state;
+    storeClockRam();
+    if((state == LOCKED_STATE_ID) != (flash_state_id == LOCKED_STATE_ID)){ //Locked or unlocked with the PIN
+      commitStoredState();
+    }
+  }
+}
+
+uint64_t storedCombination(){
+  return stored.combination;
+}
+
+//Update the combination stored in the flash memory:
+void storeCombination(uint64_t combo){
+  if(storedCombination() != combo){
+    stored.combination = combo;
+    commitStoredState();
+  }
+}
+
+//Enter the time-locked state with the given lock window, in a single write to the DS1302's RAM:
+void storeTimeLock(uint32_t locked_at, uint32_t locked_until){
+  stored.state_id = TIME_LOCKED_STATE_ID;
+  stored.locked_at_time = locked_at;
+  stored.locked_until_time = locked_until;
+  storeClockRam();
+}
+
+#endif
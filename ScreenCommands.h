@@ -1,15 +1,47 @@
 #ifndef SCREEN_COMMANDS_H
 #define SCREEN_COMMANDS_H
 
+/*
+ * Text that never changes is laid out at compile time (see ScreenText.h): its position is worked
+ * out by the compiler from the length of the string and the width of the fixed font, so drawing
+ * it does not measure it. printCenter() is for text built at run time.
+ */
+struct PlacedText{
+  const char* text;
+  const uint8_t* font;
+  uint8_t x;
+  uint8_t y; //In pixels, a multiple of 8
+};
+
+//The x coordinate that centers a string literal in a fixed font of char_width pixels per character:
+template<size_t N>
+constexpr uint8_t centeredX(const char (&)[N], uint8_t char_width){
+  return (SCREEN_WIDTH - (N - 1)*char_width)/2;
+}
+
+void drawText(const PlacedText& text){
+  fb_setFixedFont(text.font);
+  fb_printFixed(text.x, text.y, text.text, STYLE_NORMAL);
+}
+
 //Prints text to the center of the screen:
 void printCenter(const char* msg, uint8_t y_coord = 32){
-  ssd1306_printFixed((128-ssd1306_getTextSize(msg, NULL))/2, y_coord, msg, STYLE_NORMAL);
+  fb_printFixed((128-fb_getTextWidth(msg))/2, y_coord, msg, STYLE_NORMAL);
 }
 
 //Prints text at the given coordinates
 void printRelative(const char* msg, float x_coord, float y_coord){
-  lcduint_t* text_y_size;
-  lcduint_t text_x_size = ssd1306_getTextSize(msg, text_y_size);
-  ssd1306_printFixed(128*x_coord - text_x_size/2, 64*y_coord - (*text_y_size)/2, msg, STYLE_NORMAL);
+  uint8_t text_x_size = fb_getTextWidth(msg);
+  uint8_t text_y_size = pgm_read_byte(&fb_font[2]);
+  fb_printFixed(128*x_coord - text_x_size/2, 64*y_coord - text_y_size/2, msg, STYLE_NORMAL);
+}
+
+//Draws a glyph from the digit atlas. y is given in pages. Selected digits are drawn inverted.
+void drawDigit(uint8_t x, uint8_t y, uint8_t digit, bool selected = false){
+  if(selected){
+    fb_negativeMode();
+  }
+  fb_drawBitmap(x, y, DIGIT_WIDTH, DIGIT_HEIGHT, DigitGlyphs[digit]);
+  fb_positiveMode();
 }
 #endif
@@ -0,0 +1,43 @@
+#ifndef SCREEN_TEXT_H
+#define SCREEN_TEXT_H
+
+/*
+ * The fixed text of the screens, placed at compile time (see PlacedText in ScreenCommands.h).
+ * The strings and the table are constant, so they stay in flash and are read from there.
+ * Centered text whose string is too long for a line does not compile.
+ */
+
+#define SMALL_FONT ssd1306xled_font6x8
+#define SMALL_FONT_WIDTH 6
+
+//Declares a line of text in the small font, centered horizontally at y:
+#define CENTERED_TEXT(name, y, string) \
+  constexpr char name##_string[] PROGMEM = string; \
+  static_assert(sizeof(string) - 1 <= SCREEN_WIDTH / SMALL_FONT_WIDTH, "Does not fit on a line: " string); \
+  constexpr PlacedText name = {name##_string, SMALL_FONT, centeredX(string, SMALL_FONT_WIDTH), y};
+
+//Main menu:
+CENTERED_TEXT(text_box_unlocked, 0, "Box unlocked.")
+
+//Combination and duration entry:
+CENTERED_TEXT(text_set_combination, 0, "Set combination:")
+CENTERED_TEXT(text_enter_combination, 0, "Enter combination:")
+CENTERED_TEXT(text_incorrect_password, 0, "Incorrect password.")
+CENTERED_TEXT(text_set_duration, 0, "Set duration:")
+CENTERED_TEXT(text_cancel, 56, "< Cancel?")
+CENTERED_TEXT(text_confirm, 56, "Confirm? >")
+CENTERED_TEXT(text_unlocked, 32, "Unlocked!")
+
+//Time lock:
+CENTERED_TEXT(text_time_to_unlock, 0, "Time to unlock: ")
+CENTERED_TEXT(text_current_time, 40, "Current time: ")
+CENTERED_TEXT(text_duration_elapsed, 0, "Duration elapsed.")
+CENTERED_TEXT(text_press_any_key, 24, "Press any key")
+CENTERED_TEXT(text_to_unlock, 32, "to unlock.")
+
+//Diagnostics and history:
+CENTERED_TEXT(text_diagnostics_title, 0, "< Diagnostics  Dump >")
+CENTERED_TEXT(text_history_title, 0, "< Back History  -1d >")
+CENTERED_TEXT(text_no_entries, 32, "No entries")
+
+#endif
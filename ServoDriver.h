@@ -0,0 +1,126 @@
+#ifndef SERVO_DRIVER_H
+#define SERVO_DRIVER_H
+
+/*
+ * Moves the servo along a trapezoidal motion profile (accelerate, cruise, decelerate) instead
+ * of commanding the end position at once. A timer calls servoUpdate(), which sends the next
+ * position once per servo frame, so moving never blocks.
+ *
+ * Ramping keeps the servo from drawing its full stall current from the AAA pack at the start
+ * of a move. The servo is powered for as long as the move takes plus a short settling time,
+ * so a short move costs less than a long one. If SERVO_SENSE_PIN is defined (servo current
+ * through a sense resistor), the power is cut as soon as the current shows that the servo has
+ * stopped, either at its target or stalled against the end of the rack.
+ */
+
+#define SERVO_MAX_SPEED 300.0 //Degrees per second
+#define SERVO_ACCELERATION 1500.0 //Degrees per second squared
+#define SERVO_STEP_PERIOD 20 //One position update per servo PWM frame
+#define SERVO_SETTLE_TIME 150 //How long the servo stays powered after the profile has reached the target
+
+//Only used with SERVO_SENSE_PIN, in ADC counts (12 bits):
+#define SERVO_IDLE_CURRENT 60 //Below this the servo holds its position without effort
+#define SERVO_STALL_CURRENT 900 //Above this the servo is pushing against the end stop
+
+static int servo_start = 0; //Angle at the start of the current move
+static int servo_target = 0;
+static int servo_angle = 0; //Last angle sent to the servo
+static unsigned long servo_move_start = 0; //millis() when the current move started
+static unsigned long servo_move_time = 0; //Duration of the current move's profile
+static bool servo_powered = false;
+
+void servoUpdate();
+static Timer servo_timer = {servoUpdate}; //Runs every SERVO_STEP_PERIOD while the servo is powered
+
+//Duration of the profile for a move of the given distance, in milliseconds:
+unsigned long servoProfileTime(float distance){
+  const float ramp_distance = SERVO_MAX_SPEED * SERVO_MAX_SPEED / SERVO_ACCELERATION; //Both ramps to full speed and back
+  if(distance < ramp_distance){ //Never reaches full speed
+    return 2000 * sqrtf(distance / SERVO_ACCELERATION);
+  }
+  return 1000 * (SERVO_MAX_SPEED / SERVO_ACCELERATION + distance / SERVO_MAX_SPEED);
+}
+
+//Distance covered t milliseconds into the profile of a move of the given distance:
+float servoProfileDistance(float distance, unsigned long t){
+  float total = servoProfileTime(distance) / 1000.0;
+  float time = t / 1000.0;
+  if(time >= total){
+    return distance;
+  }
+  float ramp_time = min(SERVO_MAX_SPEED / SERVO_ACCELERATION, total / 2.0); //Shorter on a move that never reaches full speed
+  float peak_speed = ramp_time * SERVO_ACCELERATION;
+  if(time < ramp_time){ //Accelerating
+    return SERVO_ACCELERATION * time * time / 2;
+  }
+  if(time < total - ramp_time){ //Cruising
+    return peak_speed * ramp_time / 2 + peak_speed * (time - ramp_time);
+  }
+  float remaining = total - time; //Decelerating
+  return distance - SERVO_ACCELERATION * remaining * remaining / 2;
+}
+
+//Sets the position the servo is assumed to be in at power-on (from the stored state).
+void servoInit(int angle){
+  servo_start = servo_target = servo_angle = angle;
+}
+
+//Starts a move to servo_pos. The servo is powered until the move is over.
+void move_servo(const int servo_pos){
+  servo_start = servo_angle;
+  servo_target = servo_pos;
+  servo_move_start = millis();
+  servo_move_time = servoProfileTime(abs(servo_target - servo_start));
+  if(!servo_powered){
+    trace(TRACE_SERVO_ON);
+    digitalWrite(SERVO_TRANSISTOR_PIN, HIGH); //Enable the servo transistor
+    energyServoPower(true);
+    servo.attach(SERVO_PIN);
+    servo_powered = true;
+    timerStart(servo_timer, SERVO_STEP_PERIOD, SERVO_STEP_PERIOD);
+  }
+  servo.write(servo_angle);
+}
+
+void servoPowerOff(){
+  trace(TRACE_SERVO_OFF);
+  servo.detach();
+  digitalWrite(SERVO_TRANSISTOR_PIN, LOW); //Disable the servo transistor
+  energyServoPower(false);
+  servo_powered = false;
+  timerStop(servo_timer);
+}
+
+//Whether the servo has stopped, judging by its current. Always false without a sense input.
+bool servoStopped(){
+#ifdef SERVO_SENSE_PIN
+  analogReadResolution(12);
+  int current = analogRead(SERVO_SENSE_PIN);
+  return current < SERVO_IDLE_CURRENT || current > SERVO_STALL_CURRENT;
+#else
+  return false;
+#endif
+}
+
+//Called by servo_timer. Sends the next position of the profile, and turns the servo off once the move is over.
+void servoUpdate(){
+  unsigned long elapsed = millis() - servo_move_start;
+  if(elapsed < servo_move_time){
+    int distance = servoProfileDistance(abs(servo_target - servo_start), elapsed) + 0.5;
+    int angle = servo_target > servo_start ? servo_start + distance : servo_start - distance;
+    if(angle != servo_angle){
+      servo_angle = angle;
+      servo.write(servo_angle);
+    }
+  }else{
+    if(servo_angle != servo_target){
+      servo_angle = servo_target;
+      servo.write(servo_angle);
+    }
+    if(elapsed >= servo_move_time + SERVO_SETTLE_TIME || servoStopped()){
+      servoPowerOff();
+    }
+  }
+}
+
+#endif
@@ -8,99 +8,74 @@
    2 = Set combination
    3 = Time-Locked
    4 = Set duration
-   5 = Sleep
+   5 = Diagnostics
+   6 = History
    */
 #define UNLOCKED_STATE_ID 0
 #define LOCKED_STATE_ID 1
 #define SETCOMBO_STATE_ID 2
 #define TIME_LOCKED_STATE_ID 3
 #define SET_DURATION_STATE_ID 4
-#define SLEEP_STATE_ID 5
+#define DIAGNOSTICS_STATE_ID 5
+#define HISTORY_STATE_ID 6
 
 #define DEBOUNCE_TIME 100 //Button debounce
 
-static unsigned long lastPress = 0; //For interrupt debouncing
-static unsigned long pressTime = 0; //A variable for storing the time a button was pressed for comparison with lastPress
+static volatile unsigned long lastPress = 0; //For interrupt debouncing
+static volatile unsigned long pressTime = 0; //A variable for storing the time a button was pressed for comparison with lastPress
 
-//Reserve space for permanent stored data in Flash memory:
-FlashStorage(stored_state_id, uint8_t);
-FlashStorage(stored_combination, uint32_t);
-FlashStorage(locked_at_time, uint32_t);
-FlashStorage(locked_until_time, uint32_t);
+//Permanent stored data (state, combination and time lock) is kept in flash:
+#include "PersistentState.h"
 
-
-//Update the state stored in the flash memory:
-void storeState(uint8_t state){
-  if(stored_state_id.read() != state){
-    noInterrupts();
-    stored_state_id.write(state);
-    interrupts();
-  }
-}
-
-//Update the combination stored in the flash memory:
-void storeCombination(uint32_t combo){
-  if(stored_combination.read() != combo){
-    noInterrupts();
-    stored_combination.write(combo);
-    interrupts();
-  }
-}
-
-bool hasElapsed(const unsigned long& startTime, int duration){ //This function accounts for at most one millis() rollover
-  //return millis() >= startTime ? millis()-startTime > duration : (static_cast<unsigned long>(-1)-startTime+millis()) > duration;
-  if(millis() >= startTime){
-    return millis()-startTime > duration;
-  }else{
-    uint64_t elapsedTime = static_cast<unsigned long>(-1)-startTime+millis();
-    return elapsedTime >= duration;
-  }
+//Whether more than duration milliseconds have passed since startTime. Unsigned subtraction handles a millis() rollover.
+bool hasElapsed(const unsigned long startTime, unsigned long duration){
+  return millis() - startTime > duration;
 }
 
-struct State{
-  uint8_t state_id;
+/*
+ * Each state is a struct with handler functions, and there is exactly one instance of each.
+ * The handlers are called through state_table (defined after the states), which lists the
+ * handlers of every state in state ID order. The table is built at compile time and lives in
+ * flash, so dispatching a button press is a table lookup. A handler that a state does not need
+ * is left out of its struct and is nullptr in the table, which costs nothing.
+ *
+ * A state may define:
+ *   initialize()  Executes when the box transfers into this state
+ *   finalize()    Executes right before the box transfers out of this state
+ *   upButton()    Executes when the up button is pressed
+ *   downButton(), leftButton(), rightButton()
+ *   tick()        Executes once per second while this state is active
+ *   render()      Draws the screen, or the parts of it marked in render_dirty
+ *
+ * The other handlers do not draw. They change the state's data and mark what it changed with
+ * requestRedraw(), and the main loop calls render() at most once every FRAME_INTERVAL (see
+ * renderFrame()). A burst of presses, or leaving one state and entering the next, is drawn as
+ * one frame, and a press is on the screen at most FRAME_INTERVAL after its handler ran.
+ */
+#define STATE_COUNT 7
 
-  virtual void initialize() = 0; //Executes when the box transfers into this state
-  virtual void finalize() = 0; //Executes right before the box transfers out of this state
+#define RENDER_ALL 0x8000 //Redraw the whole screen. The lower bits are parts a state can redraw alone (e.g. one digit)
+#define FRAME_INTERVAL 40 //Shortest time between two frames, in milliseconds
 
-  virtual void upButton() = 0; //Executes when the up button is pressed
-  virtual void downButton() = 0;
-  virtual void leftButton() = 0;
-  virtual void rightButton() = 0;
+static uint8_t curr_state_id = UNLOCKED_STATE_ID;
+static uint16_t render_dirty = 0; //RENDER_ALL and/or the current state's parts to redraw
 
-  virtual void tick() = 0; //Executes once per second while this state is active
-};
+void requestRedraw(uint16_t parts = RENDER_ALL){
+  render_dirty |= parts;
+}
 
-static State* curr_state = nullptr;
-static State* last_state = nullptr;
+//The history of locks and unlocks is kept in flash too:
+#include "AuditLog.h"
 
+void transferTo(uint8_t next_state_id); //Defined after the state table
+void renderFrame();
 
-//Forward declarations of mutually referenced states:
+//Define this device's states:
 //NAMING CONVENTION:
-// No leading underscore = pointer to a state
 // One leading underscore = the name of a state
-// Two leading underscores = an instance of a state
-static State* UnlockedScreen = nullptr;
-static State* SetCombo = nullptr;
-static State* LockedScreen = nullptr;
-static State* SetDuration = nullptr;
-static State* TimeLockedScreen = nullptr;
-static State* SleepState = nullptr;
-
-//Function to transfer out of the current state and into next_state:
-void transferTo(State* next_state){
-  curr_state->finalize();
-  if(curr_state != SleepState){
-    last_state = curr_state;
-  }
-  curr_state = next_state;
-  curr_state->initialize();
-}
+// Two leading underscores = the instance of a state
 
-//Define this device's states:
-
-struct _UnlockedScreen: public State{
-  uint8_t state_id = UNLOCKED_STATE_ID;
+struct _UnlockedScreen{
   uint8_t substate_id = 0;
 
   /*
@@ -111,68 +86,66 @@ struct _UnlockedScreen: public State{
    */
 
   void initialize(){
-    //Turn the display on:
-    ssd1306_displayOn();
     //Select the default menu option:
     substate_id = 0;
-    //Draw the menu for the first time:
-    draw_menu();
-  }
-
-  void finalize(){
-    ssd1306_clearScreen();
   }
 
   void upButton(){ //Moves up on the menu
     if(substate_id > 0){
       substate_id--;
-      draw_menu();
+      requestRedraw();
     }
   }
 
   void downButton(){ //Moves down on the menu
     if(substate_id < 2){
       substate_id++;
-      draw_menu();
+      requestRedraw();
     }
   }
 
-  void leftButton(){ //Does nothing
-    //transferTo(SleepState);
+  void leftButton(){ //Opens the diagnostics screen
+    transferTo(DIAGNOSTICS_STATE_ID);
   }
 
   void rightButton(){ //Transfers to the selected state
     if(substate_id == 0){ //Lock and send to sleep state
       //DISPLAY LOCKED IMAGE
+      audit(AUDIT_LOCKED);
       storeState(LOCKED_STATE_ID); //The box is now locked
       move_servo(LOCKED_POSITION);
-      transferTo(LockedScreen); //Transfer to the sleep state
+      transferTo(LOCKED_STATE_ID); //Transfer to the sleep state
     }else if(substate_id == 1){ //Set combination.
-      transferTo(SetCombo);
+      transferTo(SETCOMBO_STATE_ID);
     }else if(substate_id == 2){ //Time lock.
-      transferTo(SetDuration);
+      transferTo(SET_DURATION_STATE_ID);
     }
   }
 
-  void tick(){}
+  void render(){
+    fb_setFixedFont(ssd1306xled_font6x8);
+    fb_clearScreen();
+    drawText(text_box_unlocked);
+    fb_setFixedFont(ssd1306xled_font8x16);
+    //fb_clearBlock(0, 30, 128, 40);
+    
+    draw_item(0, 16, "Lock");
+    draw_item(1, 32, "Set code");
+    draw_item(2, 48, "Time lock");
+  }
 
   //Helper functions for this state:
-  void draw_menu(){
-    
-    ssd1306_setFixedFont(ssd1306xled_font6x8);
-    ssd1306_clearScreen();
-    printCenter(("Box unlocked."), 0);
-    ssd1306_setFixedFont(ssd1306xled_font8x16);
-    //ssd1306_clearBlock(0, 30, 128, 40);
-    
-    ssd1306_printFixed(8, 16, (String(F("Lock"))+String(substate_id == 0 ? F(" >") : F(""))).c_str(), substate_id == 0 ? STYLE_BOLD : STYLE_NORMAL);
-    ssd1306_printFixed(8, 32, (String(F("Set code"))+String(substate_id == 1 ? F(" >") : F(""))).c_str(), substate_id == 1 ? STYLE_BOLD : STYLE_NORMAL);
-    ssd1306_printFixed(8, 48, (String(F("Time lock"))+String(substate_id == 2 ? F(" >") : F(""))).c_str(), substate_id == 2 ? STYLE_BOLD : STYLE_NORMAL);
+  void draw_item(uint8_t item, uint8_t y, const char* label){ //Draws a menu option, highlighted if it is selected
+    TextBuffer text;
+    text.append(label);
+    if(substate_id == item){
+      text.append(" >");
+    }
+    fb_printFixed(8, y, text.c_str(), substate_id == item ? STYLE_BOLD : STYLE_NORMAL);
   }
 } __UnlockedScreen;
 
-struct _SetCombo: public State{
-  uint8_t state_id = SETCOMBO_STATE_ID;
+struct _SetCombo{
   int8_t substate_id = 0;
 
   /*
@@ -187,21 +160,7 @@ struct _SetCombo: public State{
   void initialize(){
     substate_id = 0;
     //Read the combo from flash:
-    String combo_string = String(stored_combination.read());
-    int num_preceding_zeros = COMBO_LENGTH - combo_string.length(); //The number of zeros preceding the number
-    for(uint8_t i = 0; i < COMBO_LENGTH; i++){ //Take the numbers in the string and save them as integers in the combo array
-      if(i < num_preceding_zeros){
-        curr_combo[i] = 0;
-      }else{
-        curr_combo[i] = String(combo_string[i-num_preceding_zeros]).toInt();
-      }
-    }
-    //Print the combination to the screen:
-    printCombo();
-  }
-
-  void finalize(){
-    ssd1306_clearScreen();
+    unpackCombo(storedCombination(), curr_combo);
   }
 
   void upButton(){ //Increase the current digit.
@@ -211,7 +170,7 @@ struct _SetCombo: public State{
       }else{
         curr_combo[substate_id] = 0;
       }
-      printCombo();
+      requestRedraw(1 << substate_id);
     }
   }
 
@@ -222,80 +181,82 @@ struct _SetCombo: public State{
       }else{
         curr_combo[substate_id] = 9;
       }
-      printCombo();
+      requestRedraw(1 << substate_id);
     }
   }
 
   void leftButton(){ //Decrease the substate ID
     if(substate_id > -1){
       substate_id--;
-      printCombo();
+      requestRedraw();
     }else if(substate_id == -1){
       //Cancel.
-      transferTo(UnlockedScreen);
+      transferTo(UNLOCKED_STATE_ID);
     }
   }
 
   void rightButton(){
     if(substate_id < COMBO_LENGTH){ //Move right on the menu
       substate_id++;
-      printCombo();
+      requestRedraw();
     }else if(substate_id == COMBO_LENGTH){ //Save the set password to flash
-      String combo_string = "";
-      for(int i = 0; i < COMBO_LENGTH; i++){
-        combo_string += String(curr_combo[i]);
-      }
-      storeCombination(combo_string.toInt());
-      transferTo(UnlockedScreen);
+      storeCombination(packCombo(curr_combo));
+      transferTo(UNLOCKED_STATE_ID);
     }
   }
 
-  void tick(){}
+  void render(){
+    if(render_dirty & RENDER_ALL){
+      printCombo();
+      return;
+    }
+    for(int8_t i = 0; i < COMBO_LENGTH; i++){
+      if(render_dirty & 1 << i){
+        printDigit(i);
+      }
+    }
+  }
 
   //Helper functions for this state:
   void printCombo(){
-    ssd1306_clearScreen();
-    ssd1306_setFixedFont(ssd1306xled_font6x8);
-    printCenter(("Set combination:"), 0);
-    ssd1306_setFixedFont(courier_new_font11x16_digits);
+    fb_clearScreen();
+    drawText(text_set_combination);
     for(int i = 0; i < COMBO_LENGTH; i++){
-      if(i == substate_id){ //If the current digit is selected, draw the arrows and highlight the number
-        ssd1306_drawBitmap((113 - COMBO_LENGTH*11)/2 + 11*i, 2, 24, 8, UpArrow);
-        ssd1306_drawBitmap((113 - COMBO_LENGTH*11)/2 + 11*i, 7, 24, 8, DownArrow);
-        ssd1306_negativeMode();
-      }else{
-        ssd1306_positiveMode();
+      if(i == substate_id){ //If the current digit is selected, draw the arrows above and below it
+        fb_drawBitmap((113 - COMBO_LENGTH*DIGIT_WIDTH)/2 + DIGIT_WIDTH*i, 2, 24, 8, UpArrow);
+        fb_drawBitmap((113 - COMBO_LENGTH*DIGIT_WIDTH)/2 + DIGIT_WIDTH*i, 7, 24, 8, DownArrow);
       }
-      ssd1306_printFixed((128 - COMBO_LENGTH*11)/2 + 11*i, 32, String(curr_combo[i]).c_str(), STYLE_NORMAL);
-      
+      printDigit(i);
     }
-    ssd1306_positiveMode();
     if(substate_id == -1){
-      ssd1306_setFixedFont(ssd1306xled_font6x8);
-      printCenter(("< Cancel?"), 56);
+      drawText(text_cancel);
     }else if(substate_id == COMBO_LENGTH){
-      ssd1306_setFixedFont(ssd1306xled_font6x8);
-      printCenter(("Confirm? >"), 56);
+      drawText(text_confirm);
     }  
   }
+
+  //Redraws one digit of the combination, highlighted if it is selected:
+  void printDigit(int8_t i){
+    drawDigit((128 - COMBO_LENGTH*DIGIT_WIDTH)/2 + DIGIT_WIDTH*i, 4, curr_combo[i], i == substate_id);
+  }
 } __SetCombo;
 
 //The screen the user sees while the device is locked. This is where the password is entered.
-struct _LockedScreen: public State{
-  uint8_t state_id = LOCKED_STATE_ID;
+struct _LockedScreen{
   int8_t substate_id = 0;
 
   uint8_t curr_combo[COMBO_LENGTH] = {0}; //The combination currently displayed on the screen
+  bool password_rejected = false; //"Incorrect password." replaces the title until the selection or a digit changes
+  bool unlocking = false; //The combination was accepted: "Unlocked!" replaces the screen while the box unlocks
 
   void initialize(){
     substate_id = 0; //Set the default selection on the menu
-    //Print the combination to the screen:
-    printCombo();
+    password_rejected = false;
+    unlocking = false;
   }
 
   void finalize(){
     memset(curr_combo, 0, COMBO_LENGTH); //Clear the entered password field
-    ssd1306_clearScreen();
   }
 
   void upButton(){ //Increase the current digit.
@@ -305,7 +266,7 @@ struct _LockedScreen: public State{
       }else{
         curr_combo[substate_id] = 0;
       }
-      printCombo();
+      updateDigit();
     }
   }
 
@@ -316,81 +277,101 @@ struct _LockedScreen: public State{
       }else{
         curr_combo[substate_id] = 9;
       }
-      printCombo();
+      updateDigit();
     }
   }
 
   void leftButton(){ //Decrease the substate ID
     if(substate_id > -1){
       substate_id--;
-      printCombo();
+      password_rejected = false;
+      requestRedraw();
     }else if(substate_id == -1){
       //Cancel.
-      //Transfer to the sleep state:
-      //transferTo(SleepState);
+      //Put the box to sleep:
+      //sleepUntilWoken();
     }
   }
 
   void rightButton(){
     if(substate_id < COMBO_LENGTH){ //Move right on the menu
       substate_id++;
-      printCombo();
+      password_rejected = false;
+      requestRedraw();
     }else if(substate_id == COMBO_LENGTH){ //Check if the password is correct.
-      String combo_string = "";
-      for(int i = 0; i < COMBO_LENGTH; i++){ //Take the individual digits in the curr_combo array and convert them into a single integer
-        combo_string += String(curr_combo[i]);
-      }
-      if(stored_combination.read() == combo_string.toInt()){ //Unlock the device. Display an unlocked symbol while the servo actuates, then transfer to the unlocked screen
-        ssd1306_setFixedFont(ssd1306xled_font6x8);
-        ssd1306_clearScreen();
-        printCenter("Unlocked!", 32); //REPLACE THIS WITH AN IMAGE
+      if(comboEquals(packCombo(curr_combo), storedCombination())){ //Unlock the device. Display an unlocked symbol while the servo actuates, then transfer to the unlocked screen
+        unlocking = true;
+        requestRedraw();
+        renderFrame(); //The one frame drawn from a handler: the message must show while the state is stored
+        fb_flush();
+        audit(AUDIT_UNLOCKED);
         storeState(UNLOCKED_STATE_ID);
         move_servo(UNLOCKED_POSITION);
-        transferTo(UnlockedScreen);
+        transferTo(UNLOCKED_STATE_ID);
       }else{ //The password is incorrect. Inform the user and delay.
         //We remain in the current state.
+        audit(AUDIT_WRONG_PIN);
         memset(curr_combo, 0, COMBO_LENGTH); //Clear the entered password field
         substate_id = 0;
-        printCombo();
-        ssd1306_clearBlock(0, 0, 128, 8);
-        ssd1306_setFixedFont(ssd1306xled_font6x8);
-        printCenter("Incorrect password.", 0);
+        password_rejected = true;
+        requestRedraw();
       }
     }
   }
 
-  void tick(){}
+  void render(){
+    if(unlocking){
+      fb_clearScreen();
+      drawText(text_unlocked); //REPLACE THIS WITH AN IMAGE
+      return;
+    }
+    if(render_dirty & RENDER_ALL){
+      printCombo();
+      return;
+    }
+    for(int8_t i = 0; i < COMBO_LENGTH; i++){
+      if(render_dirty & 1 << i){
+        printDigit(i);
+      }
+    }
+  }
 
   //Helper functions for this state:
   void printCombo(){ //The screen that allows the user to enter the combination and unlock the box
-    ssd1306_clearScreen();
-    ssd1306_setFixedFont(ssd1306xled_font6x8);
-    printCenter(("Enter combination:"), 0);
-    ssd1306_setFixedFont(courier_new_font11x16_digits);
+    fb_clearScreen();
+    drawText(password_rejected ? text_incorrect_password : text_enter_combination);
     for(int i = 0; i < COMBO_LENGTH; i++){
-      if(i == substate_id){ //If the current digit is selected, draw the arrows and highlight the number
-        ssd1306_drawBitmap((113 - COMBO_LENGTH*11)/2 + 11*i, 2, 24, 8, UpArrow);
-        ssd1306_drawBitmap((113 - COMBO_LENGTH*11)/2 + 11*i, 7, 24, 8, DownArrow);
-        ssd1306_negativeMode();
-      }else{
-        ssd1306_positiveMode();
+      if(i == substate_id){ //If the current digit is selected, draw the arrows above and below it
+        fb_drawBitmap((113 - COMBO_LENGTH*DIGIT_WIDTH)/2 + DIGIT_WIDTH*i, 2, 24, 8, UpArrow);
+        fb_drawBitmap((113 - COMBO_LENGTH*DIGIT_WIDTH)/2 + DIGIT_WIDTH*i, 7, 24, 8, DownArrow);
       }
-      ssd1306_printFixed((128 - COMBO_LENGTH*11)/2 + 11*i, 32, String(curr_combo[i]).c_str(), STYLE_NORMAL);
-      
+      printDigit(i);
     }
-    ssd1306_positiveMode();
     if(substate_id == -1){
-      //ssd1306_setFixedFont(ssd1306xled_font6x8);
-      //printCenter(("< Cancel?"), 56);
+      //fb_setFixedFont(ssd1306xled_font6x8);
+      //drawText(text_cancel);
     }else if(substate_id == COMBO_LENGTH){
-      ssd1306_setFixedFont(ssd1306xled_font6x8);
-      printCenter(("Confirm? >"), 56);
+      drawText(text_confirm);
     }  
   }
+
+  //Marks the selected digit for a redraw after it changed, or the whole screen if it still shows an error:
+  void updateDigit(){
+    if(password_rejected){
+      password_rejected = false;
+      requestRedraw();
+    }else{
+      requestRedraw(1 << substate_id);
+    }
+  }
+
+  //Redraws one digit of the combination, highlighted if it is selected:
+  void printDigit(int8_t i){
+    drawDigit((128 - COMBO_LENGTH*DIGIT_WIDTH)/2 + DIGIT_WIDTH*i, 4, curr_combo[i], i == substate_id);
+  }
 } __LockedScreen; 
 
-struct _SetDuration: public State{
-  uint8_t state_id = SET_DURATION_STATE_ID;
+struct _SetDuration{
   int8_t substate_id = 0;
 
   /*
@@ -404,13 +385,10 @@ struct _SetDuration: public State{
 
   void initialize(){
     substate_id = 0;
-    //Print the combination to the screen:
-    printCombo();
   }
 
   void finalize(){
     memset(curr_combo, 0, 3); //Clear the entered password field
-    ssd1306_clearScreen();
   }
 
   void upButton(){ //Increase the current digit.
@@ -420,21 +398,21 @@ struct _SetDuration: public State{
       }else{
         curr_combo[substate_id] = 0;
       }
-      printCombo();
+      requestRedraw(1 << substate_id);
     }else if(substate_id == 1){ //Hours
       if(curr_combo[substate_id] < MAX_HOURS){
         curr_combo[substate_id]++;
       }else{
         curr_combo[substate_id] = 0;
       }
-      printCombo();
+      requestRedraw(1 << substate_id);
     }else if(substate_id == 2){ //Minutes
       if(curr_combo[substate_id] < MAX_MINUTES){
         curr_combo[substate_id]++;
       }else{
         curr_combo[substate_id] = 0;
       }
-      printCombo();
+      requestRedraw(1 << substate_id);
     }
   }
 
@@ -445,98 +423,95 @@ struct _SetDuration: public State{
       }else{
         curr_combo[substate_id] = MAX_DAYS;
       }
-      printCombo();
+      requestRedraw(1 << substate_id);
     }else if(substate_id == 1){ //Hours
       if(curr_combo[substate_id] > 0){
         curr_combo[substate_id]--;
       }else{
         curr_combo[substate_id] = MAX_HOURS;
       }
-      printCombo();
+      requestRedraw(1 << substate_id);
     }else if(substate_id == 2){ //Minutes
       if(curr_combo[substate_id] > 0){
         curr_combo[substate_id]--;
       }else{
         curr_combo[substate_id] = MAX_MINUTES;
       }
-      printCombo();
+      requestRedraw(1 << substate_id);
     }
   }
 
   void leftButton(){ //Decrease the substate ID
     if(substate_id > -1){
       substate_id--;
-      printCombo();
+      requestRedraw();
     }else if(substate_id == -1){
       //Cancel.
-      transferTo(UnlockedScreen);
+      transferTo(UNLOCKED_STATE_ID);
     }
   }
 
   void rightButton(){
     if(substate_id < 3){ //Move right on the menu
       substate_id++;
-      printCombo();
+      requestRedraw();
     }else if(substate_id == 3){ //Save the set password to flash
       //Convert the duration array into seconds:
       uint32_t duration = curr_combo[0]*86400 + curr_combo[1]*3600 + curr_combo[2]*60;
       //Add that duration to the current unix timestamp and save to flash
-      Time t = rtc.time(); //Get the current time
-      uint32_t current_timestamp = time_to_timestamp(t);
-      locked_at_time.write(current_timestamp); //Record the time at which the box was locked. This will help for clock function verification later
-      locked_until_time.write(current_timestamp + duration); //This is the timestamp at which the box will unlock
-      stored_state_id.write(TIME_LOCKED_STATE_ID); //The box now will now remember that it is locked
+      uint32_t current_timestamp = currentTimestamp();
+      //Record the time at which the box was locked (this will help for clock function verification later)
+      //and the timestamp at which the box will unlock. The box will now remember that it is locked.
+      audit(AUDIT_TIME_LOCKED);
+      storeTimeLock(current_timestamp, current_timestamp + duration);
       move_servo(LOCKED_POSITION); //Lock the box.
-      transferTo(TimeLockedScreen);
+      transferTo(TIME_LOCKED_STATE_ID);
     }
   }
 
- void tick(){}
-  
- void printCombo(){
-    ssd1306_clearScreen();
-    ssd1306_setFixedFont(ssd1306xled_font6x8);
-    printCenter("Set duration:", 0);
-    ssd1306_setFixedFont(courier_new_font11x16_digits);
-    for(int i = 0; i < 3; i++){
-      if(i == substate_id){
-        ssd1306_negativeMode();
-      }else{
-        ssd1306_positiveMode();
+  void render(){
+    if(render_dirty & RENDER_ALL){
+      printCombo();
+      return;
+    }
+    for(int8_t i = 0; i < 3; i++){
+      if(render_dirty & 1 << i){
+        printNumber(i);
       }
-      ssd1306_printFixed(20+33*i, 32, (String(curr_combo[i] < 10 ? "0" : "") + String(curr_combo[i])).c_str(), STYLE_NORMAL);
-      ssd1306_positiveMode();
-      ssd1306_printFixed(42, 32, ":", STYLE_NORMAL);
-      ssd1306_printFixed(75, 32, ":", STYLE_NORMAL);
     }
+  }
+
+  //Helper functions for this state:
+  void printCombo(){
+    fb_clearScreen();
+    drawText(text_set_duration);
+    for(int i = 0; i < 3; i++){
+      printNumber(i);
+    }
+    drawDigit(42, 4, COLON_GLYPH);
+    drawDigit(75, 4, COLON_GLYPH);
     if(substate_id > -1 && substate_id < 3){
-      ssd1306_drawBitmap(19+33*substate_id, 2, 24, 8, UpArrow);
-      ssd1306_drawBitmap(19+33*substate_id, 7, 24, 8, DownArrow);
+      fb_drawBitmap(19+33*substate_id, 2, 24, 8, UpArrow);
+      fb_drawBitmap(19+33*substate_id, 7, 24, 8, DownArrow);
     } else if(substate_id == -1){
-      ssd1306_setFixedFont(ssd1306xled_font6x8);
-      printCenter(("< Cancel?"), 56);
+      drawText(text_cancel);
     }else if(substate_id == 3){
-      ssd1306_setFixedFont(ssd1306xled_font6x8);
-      Time t = rtc.time();
-      printCenter(timeAsString(t).c_str(), 16);
-      printCenter(("Confirm? >"), 56);
+      fb_setFixedFont(ssd1306xled_font6x8);
+      printCenter(timeAsString(currentTime()).c_str(), 16);
+      drawText(text_confirm);
     }  
   }
 
+  //Redraws one two-digit field of the duration, highlighted if it is selected:
+  void printNumber(int8_t i){
+    drawDigit(20 + 33*i, 4, curr_combo[i] / 10, i == substate_id);
+    drawDigit(20 + 33*i + DIGIT_WIDTH, 4, curr_combo[i] % 10, i == substate_id);
+  }
 } __SetDuration; 
 
-struct _TimeLockedScreen: public State{
-  uint8_t state_id = TIME_LOCKED_STATE_ID;
+struct _TimeLockedScreen{
   uint8_t substate_id = 0;
 
-  void initialize(){
-    printScreen();
-  }
-
-  void finalize(){
-    ssd1306_clearScreen();
-  }
-
   void upButton(){
     if(!isLocked()){
       unlock();
@@ -562,19 +537,27 @@ struct _TimeLockedScreen: public State{
   }
 
   void tick(){
-    printScreen();
+#ifdef AUTO_UNLOCK
+    if(!isLocked()){
+      unlock();
+      return;
+    }
+#endif
+    requestRedraw(); //The countdown or the clock changed
   }
 
+  Timer clock_check_timer = {}; //Runs for 2 seconds after each check of the clock
+
   bool isLocked(){
     static uint32_t last_recorded_time = 0;
-    static uint32_t lastCheck = 0;
 
-    Time t = rtc.time();
-    uint32_t curr_time = time_to_timestamp(t);
+    uint32_t curr_time = currentTimestamp();
 
     //Check that the clock is still ticking
-    if(hasElapsed(lastCheck, 2000)){ //Check at most every 2 seconds. Otherwise there is a risk we will check the clock in the same second.
-      lastCheck = millis();
+    if(!timerActive(clock_check_timer)){ //Check at most every 2 seconds. Otherwise there is a risk we will check the clock in the same second.
+      timerStart(clock_check_timer, 2000);
+      //The reading is at most one tick old, so two checks 2 seconds apart always compare readings taken more than a
+      //second apart.
       if(curr_time <= last_recorded_time){ //The clock is not ticking properly. Unlock the box.
         return false;
       }
@@ -582,147 +565,419 @@ struct _TimeLockedScreen: public State{
     }
     //Check the current time to see if the box should be locked:
     //If the first check returns false, the timer is malfunctioning. If the second check returns false, then either the duration has elapsed or the timer is malfunctioning.
-    return (locked_at_time.read() <= curr_time && curr_time < locked_until_time.read());
+    return (stored.locked_at_time <= curr_time && curr_time < stored.locked_until_time);
   }
 
   void unlock(){
+    audit(AUDIT_TIME_LOCK_EXPIRED);
     move_servo(UNLOCKED_POSITION); //Unlock the box
-    stored_state_id.write(UNLOCKED_STATE_ID); //The box will now remember that it is unlocked.
-    transferTo(UnlockedScreen);
+    storeState(UNLOCKED_STATE_ID); //The box will now remember that it is unlocked.
+    transferTo(UNLOCKED_STATE_ID);
   }
 
-  void printScreen(){
-    ssd1306_clearScreen();
-    ssd1306_setFixedFont(ssd1306xled_font6x8);
+  void render(){
+    fb_clearScreen();
+    fb_setFixedFont(ssd1306xled_font6x8);
     if(isLocked()){
-      Time t = rtc.time();
-      TimeSpan ts(locked_until_time.read() - time_to_timestamp(t));
-      printCenter("Time to unlock: ", 0);
+      Time& t = currentTime(); //Already read by isLocked()
+      CivilSpan ts = spanFromSeconds(stored.locked_until_time - currentTimestamp());
+      drawText(text_time_to_unlock);
       printCenter(spanAsString(ts).c_str(), 24);
-      printCenter("Current time: ", 40);
+      drawText(text_current_time);
       printCenter(timeAsString(t).c_str(), 48);
     }else{
-      printCenter("Duration elapsed.", 0);
-      printCenter("Press any key", 24);
-      printCenter("to unlock.", 32);
+      drawText(text_duration_elapsed);
+      drawText(text_press_any_key);
+      drawText(text_to_unlock);
     }
   }
   
 } __TimeLockedScreen; 
        
-//Interrupt functions:
+//Interrupt functions. These only debounce and queue the press; the handlers run in loop().
 
-void upButtonInterrupt(){
+void buttonInterrupt(uint8_t type){
+  idleCatchUp(); //millis() stands still during a timed idle
   pressTime = millis();
+  traceFromInterrupt(TRACE_ISR, type);
   if(hasElapsed(lastPress, DEBOUNCE_TIME)){ //abs(pressTime-lastPress) > DEBOUNCE_TIME)
     lastPress = pressTime;
-
-    curr_state->upButton();
-    
+    pushEvent(type, pressTime);
+  }else{
+    traceFromInterrupt(TRACE_DEBOUNCE_REJECT, type);
   }
 }
 
+void upButtonInterrupt(){
+  buttonInterrupt(UP_BUTTON_EVENT);
+}
 
 void downButtonInterrupt(){
-  pressTime = millis();
-  if(hasElapsed(lastPress, DEBOUNCE_TIME)){
-    lastPress = pressTime;
-
-    curr_state->downButton();
-    
-  }
+  buttonInterrupt(DOWN_BUTTON_EVENT);
 }
 
 void leftButtonInterrupt(){
-  pressTime = millis();
-  if(hasElapsed(lastPress, DEBOUNCE_TIME)){
-    lastPress = pressTime;
-
-    curr_state->leftButton();
-    
-  }
+  buttonInterrupt(LEFT_BUTTON_EVENT);
 }
 
 void rightButtonInterrupt(){
-  pressTime = millis();
-  if(hasElapsed(lastPress, DEBOUNCE_TIME)){
-    lastPress = pressTime;
-
-    curr_state->rightButton();
-    
-  }
+  buttonInterrupt(RIGHT_BUTTON_EVENT);
 }
 
 void wakeUpInterrupt(){
   pressTime = millis();
-  if(curr_state == SleepState){
-    transferTo(last_state);
-  }
+  traceFromInterrupt(TRACE_ISR, WAKE_EVENT);
+  pushEvent(WAKE_EVENT, pressTime);
 }
 
-struct _SleepState: public State{
-  uint8_t state_id = SLEEP_STATE_ID;
+//Shows the energy accounting (see EnergyMonitor.h). Opened with the left button on the main menu.
+struct _DiagnosticsScreen{
   uint8_t substate_id = 0;
 
   void initialize(){
-    ssd1306_displayOff();
-    detachInterrupt(digitalPinToInterrupt(UP_BUTTON_PIN)); //Detach the current interrupt on the up button
-    LowPower.attachInterruptWakeup(UP_BUTTON_PIN, wakeUpInterrupt, RISING); //Attach the new wakeup interrupt
-    LowPower.deepSleep(); //Go to sleep
+    sampleBattery(true);
   }
 
-  void finalize(){
-    detachInterrupt(digitalPinToInterrupt(UP_BUTTON_PIN)); //Detach the current interrupt on the up button
-    attachInterrupt(digitalPinToInterrupt(UP_BUTTON_PIN), upButtonInterrupt, RISING);  //Attach the normal interrupt
-    ssd1306_displayOn();
-    ssd1306_clearScreen();
+  void leftButton(){ //Back to the main menu
+    transferTo(UNLOCKED_STATE_ID);
   }
 
-  void upButton(){}
+  void downButton(){ //Opens the history screen
+    transferTo(HISTORY_STATE_ID);
+  }
 
-  void downButton(){}
+  void rightButton(){ //Dump the report over serial
+    printEnergyReport();
+    printBootProfile();
+    printAuditLog();
+    printTrace();
+  }
+
+  void tick(){
+    requestRedraw(); //The figures changed
+  }
+
+  void render(){
+    energyUpdate();
+    fb_setFixedFont(ssd1306xled_font6x8);
+    fb_clearScreen();
+    drawText(text_diagnostics_title);
+    TextBuffer text;
+    text.append("Awake ").appendNumber(energy.awake_ms / 1000).append("s idle ").appendNumber(energy.idle_us / 1000000).append('s');
+    fb_printFixed(0, 8, text.c_str(), STYLE_NORMAL);
+    draw_line(2, "Boot   ", boot_phase_us[BOOT_FIRST_FRAME] / 1000, "ms");
+    draw_line(3, "Sleep  ", energy.sleep_s, "s");
+    draw_line(4, "Servo  ", energy.servo_ms / 1000, "s");
+    draw_line(5, "I2C    ", energy.i2c_bytes, "B");
+    text = TextBuffer();
+    text.append("Batt   ");
+    if(energy.battery_mv > 0){
+      text.appendNumber(energy.battery_mv / 1000).append('.').appendNumber(energy.battery_mv % 1000 / 10, 2).append('V');
+    }else{
+      text.append("--");
+    }
+    fb_printFixed(0, 48, text.c_str(), STYLE_NORMAL);
+    uint32_t used = energyUsedUah();
+    text = TextBuffer();
+    text.append("Used ").appendNumber(used / 1000).append('.').appendNumber(used % 1000 / 100).append("mAh ");
+    text.appendNumber(energyRemainingDays()).append("d left");
+    fb_printFixed(0, 56, text.c_str(), STYLE_NORMAL);
+  }
 
-  void leftButton(){}
+  //Helper functions for this state:
+  void draw_line(uint8_t line, const char* label, uint32_t value, const char* unit){
+    TextBuffer text;
+    text.append(label).appendNumber(value).append(unit);
+    fb_printFixed(0, line*8, text.c_str(), STYLE_NORMAL);
+  }
+} __DiagnosticsScreen;
 
-  void rightButton(){}
+#define HISTORY_LINES 7 //Entries per page
 
-  void tick(){};
-  
-} __SleepState; 
+//Shows the audit log (see AuditLog.h), newest first. Opened with the down button on the diagnostics screen.
+struct _HistoryScreen{
+  uint8_t substate_id = 0;
+  uint16_t view_end = 0; //One past the index of the newest entry on the page
+
+  void initialize(){
+    view_end = audit_count;
+  }
+
+  void upButton(){ //Newer entries
+    if(view_end < audit_count){
+      view_end = min(audit_count, (uint16_t)(view_end + HISTORY_LINES));
+      requestRedraw();
+    }
+  }
+
+  void downButton(){ //Older entries
+    if(view_end > HISTORY_LINES){
+      view_end = max((uint16_t)(view_end - HISTORY_LINES), (uint16_t)HISTORY_LINES);
+      requestRedraw();
+    }
+  }
+
+  void leftButton(){ //Back to the diagnostics screen
+    transferTo(DIAGNOSTICS_STATE_ID);
+  }
+
+  void rightButton(){ //Back one day from the newest entry on the page
+    if(view_end == 0){
+      return;
+    }
+    AuditEntry entry;
+    auditRead(view_end - 1, entry);
+    view_end = max(auditFind(entry.time - 86400 + 1), min(audit_count, (uint16_t)HISTORY_LINES));
+    requestRedraw();
+  }
+
+  void render(){
+    fb_setFixedFont(ssd1306xled_font6x8);
+    fb_clearScreen();
+    drawText(text_history_title);
+    if(audit_count == 0){
+      drawText(text_no_entries);
+      return;
+    }
+    for(uint8_t line = 1; line <= HISTORY_LINES && line <= view_end; line++){
+      AuditEntry entry;
+      auditRead(view_end - line, entry);
+      TextBuffer text;
+      if(auditValid(entry)){
+        Time t = timestampToTime(entry.time);
+        text.appendNumber(t.mon, 2).append('/').appendNumber(t.date, 2).append(' ');
+        text.appendNumber(t.hr, 2).append(':').appendNumber(t.min, 2).append(' ').append(audit_type_names[entry.type]);
+      }else{
+        text.append("--");
+      }
+      fb_printFixed(0, line*8, text.c_str(), STYLE_NORMAL);
+    }
+  }
+} __HistoryScreen;
+
+/*
+ * Sleep suspends the current state rather than leaving it: the state keeps everything it holds
+ * in RAM (the selected digit, a half-entered combination) and is not finalized or initialized
+ * again. The SSD1306 keeps its display RAM while it is switched off, and the frame buffer still
+ * matches it, so waking up only takes the display-on command. The press that wakes the box is
+ * not passed on to the state.
+ */
+void sleepUntilWoken(){
+  fb_displayOff();
+  detachInterrupt(digitalPinToInterrupt(UP_BUTTON_PIN)); //Detach the current interrupt on the up button
+  LowPower.attachInterruptWakeup(UP_BUTTON_PIN, wakeUpInterrupt, RISING); //Attach the new wakeup interrupt
+  energySleep();
+  trace(TRACE_SLEEP);
+#ifdef AUTO_UNLOCK
+  if(curr_state_id == TIME_LOCKED_STATE_ID){
+    alarmDeepSleep(stored.locked_until_time); //Wake up to unlock the box
+  }else{
+    LowPower.deepSleep();
+  }
+#else
+  LowPower.deepSleep(); //Go to sleep
+#endif
+  trace(TRACE_WAKE);
+  invalidateClock(); //millis() did not advance during the sleep, so the last DS1302 reading is stale
+  energyWake();
+  detachInterrupt(digitalPinToInterrupt(UP_BUTTON_PIN)); //Detach the wakeup interrupt
+  attachInterrupt(digitalPinToInterrupt(UP_BUTTON_PIN), upButtonInterrupt, RISING);  //Attach the normal interrupt
+  fb_displayOn();
+}
+
+//The state table:
+
+typedef void (*StateHandler)();
+
+struct StateHandlers{
+  StateHandler initialize;
+  StateHandler finalize;
+  StateHandler upButton;
+  StateHandler downButton;
+  StateHandler leftButton;
+  StateHandler rightButton;
+  StateHandler tick;
+  StateHandler render;
+};
+
+//Turns a member function of a state instance into a plain function the table can point to:
+template<class S, S& state, void (S::*handler)()>
+void callHandler(){
+  (state.*handler)();
+}
+
+//HANDLER(LockedScreen, upButton) refers to __LockedScreen.upButton(), following the naming convention:
+#define HANDLER(state, name) (&callHandler<_##state, __##state, &_##state::name>)
+#define NO_HANDLER nullptr
+
+//In state ID order:
+constexpr StateHandlers state_table[STATE_COUNT] = {
+  { //UNLOCKED_STATE_ID
+    HANDLER(UnlockedScreen, initialize), NO_HANDLER,
+    HANDLER(UnlockedScreen, upButton), HANDLER(UnlockedScreen, downButton),
+    HANDLER(UnlockedScreen, leftButton), HANDLER(UnlockedScreen, rightButton),
+    NO_HANDLER, HANDLER(UnlockedScreen, render)
+  },
+  { //LOCKED_STATE_ID
+    HANDLER(LockedScreen, initialize), HANDLER(LockedScreen, finalize),
+    HANDLER(LockedScreen, upButton), HANDLER(LockedScreen, downButton),
+    HANDLER(LockedScreen, leftButton), HANDLER(LockedScreen, rightButton),
+    NO_HANDLER, HANDLER(LockedScreen, render)
+  },
+  { //SETCOMBO_STATE_ID
+    HANDLER(SetCombo, initialize), NO_HANDLER,
+    HANDLER(SetCombo, upButton), HANDLER(SetCombo, downButton),
+    HANDLER(SetCombo, leftButton), HANDLER(SetCombo, rightButton),
+    NO_HANDLER, HANDLER(SetCombo, render)
+  },
+  { //TIME_LOCKED_STATE_ID
+    NO_HANDLER, NO_HANDLER,
+    HANDLER(TimeLockedScreen, upButton), HANDLER(TimeLockedScreen, downButton),
+    HANDLER(TimeLockedScreen, leftButton), HANDLER(TimeLockedScreen, rightButton),
+    HANDLER(TimeLockedScreen, tick), HANDLER(TimeLockedScreen, render)
+  },
+  { //SET_DURATION_STATE_ID
+    HANDLER(SetDuration, initialize), HANDLER(SetDuration, finalize),
+    HANDLER(SetDuration, upButton), HANDLER(SetDuration, downButton),
+    HANDLER(SetDuration, leftButton), HANDLER(SetDuration, rightButton),
+    NO_HANDLER, HANDLER(SetDuration, render)
+  },
+  { //DIAGNOSTICS_STATE_ID
+    HANDLER(DiagnosticsScreen, initialize), NO_HANDLER,
+    NO_HANDLER, HANDLER(DiagnosticsScreen, downButton),
+    HANDLER(DiagnosticsScreen, leftButton), HANDLER(DiagnosticsScreen, rightButton),
+    HANDLER(DiagnosticsScreen, tick), HANDLER(DiagnosticsScreen, render)
+  },
+  { //HISTORY_STATE_ID
+    HANDLER(HistoryScreen, initialize), NO_HANDLER,
+    HANDLER(HistoryScreen, upButton), HANDLER(HistoryScreen, downButton),
+    HANDLER(HistoryScreen, leftButton), HANDLER(HistoryScreen, rightButton),
+    NO_HANDLER, HANDLER(HistoryScreen, render)
+  },
+};
+
+//Runs one of the current state's handlers, if it has one:
+void runHandler(StateHandler StateHandlers::*handler){
+  StateHandler function = state_table[curr_state_id].*handler;
+  if(function != nullptr){
+    function();
+  }
+}
+
+//Function to transfer out of the current state and into next_state_id:
+void transferTo(uint8_t next_state_id){
+  cancelRepeat(); //A button held across screens does not repeat on the new one
+  trace(TRACE_TRANSFER, curr_state_id, next_state_id);
+  runHandler(&StateHandlers::finalize);
+  curr_state_id = next_state_id;
+  runHandler(&StateHandlers::initialize);
+  render_dirty = RENDER_ALL; //The old state's parts mean nothing to the new state
+}
+
+static Timer frame_timer = {}; //Runs for FRAME_INTERVAL after each frame
+
+//Draws what the current state marked dirty, right away:
+void renderFrame(){
+  if(render_dirty != 0){
+    runHandler(&StateHandlers::render);
+    render_dirty = 0;
+    timerStart(frame_timer, FRAME_INTERVAL);
+  }
+}
+
+//Called from the main loop. A frame due while frame_timer runs is drawn when it expires.
+void renderPending(){
+  if(!timerActive(frame_timer)){
+    renderFrame();
+  }
+}
+
+/*
+ * The timers of the main loop: the current state's tick function runs every TICK_PERIOD, and the
+ * box goes to sleep SLEEP_TIMEOUT after the last button press.
+ */
+void tickTimeout(){
+  trace(TRACE_HANDLER_START, TRACE_TICK, curr_state_id);
+  runHandler(&StateHandlers::tick);
+  trace(TRACE_HANDLER_END, TRACE_TICK, curr_state_id);
+}
+
+void sleepTimeout();
+
+static Timer tick_timer = {tickTimeout};
+static Timer sleep_timer = {sleepTimeout};
+
+void sleepTimeout(){
+  renderFrame();
+  fb_flush(); //Send what the handlers drew before the display goes off
+  sleepUntilWoken(); //Returns once the up button wakes the box
+  timerStart(tick_timer, 0, TICK_PERIOD); //Bring a clock display up to date right away
+  timerStart(sleep_timer, SLEEP_TIMEOUT);
+}
+
+//Runs the current state's handler for a queued event:
+void dispatchEvent(const InputEvent& event){
+  timerStart(sleep_timer, SLEEP_TIMEOUT); //Every press keeps the box awake
+  trace(TRACE_HANDLER_START, event.type, curr_state_id);
+  switch(event.type){
+    case UP_BUTTON_EVENT:
+      runHandler(&StateHandlers::upButton);
+      break;
+    case DOWN_BUTTON_EVENT:
+      runHandler(&StateHandlers::downButton);
+      break;
+    case LEFT_BUTTON_EVENT:
+      runHandler(&StateHandlers::leftButton);
+      break;
+    case RIGHT_BUTTON_EVENT:
+      runHandler(&StateHandlers::rightButton);
+      break;
+    case WAKE_EVENT: //Only wakes the box (see sleepUntilWoken())
+      break;
+  }
+  trace(TRACE_HANDLER_END, event.type, curr_state_id);
+}
 
 #endif
 
-//A template for easily making new states in the future:
+//A template for easily making new states in the future (add its handlers to state_table, leaving out the ones it doesn't need):
 /*
-struct _UnlockedScreen: public State{
-  uint8_t state_id = 0;
+struct _UnlockedScreen{
   uint8_t substate_id = 0;
 
   void initialize(){
-    printCenter("Initialized!");
+    substate_id = 0;
   }
 
   void finalize(){
-    printCenter("Finalized!");
   }
 
   void upButton(){
-    printCenter("Up");
+    substate_id = 1;
+    requestRedraw();
   }
 
   void downButton(){
-    printCenter("Down");
+    substate_id = 2;
+    requestRedraw();
   }
 
   void leftButton(){
-    printCenter("Left");
+    substate_id = 3;
+    requestRedraw();
   }
 
   void rightButton(){
-    printCenter("Right");
+    substate_id = 4;
+    requestRedraw();
   }
 
   void tick(){};
+
+  void render(){
+    fb_clearScreen();
+    printCenter(substate_id == 0 ? "Initialized!" : "Pressed", 32);
+  }
   
-} UnlockedScreen; 
+} __UnlockedScreen; 
  */
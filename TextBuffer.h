@@ -0,0 +1,53 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#define TEXT_BUFFER_SIZE 24 //A full line of the 6x8 font is 21 characters
+
+//Fixed-capacity string built on the stack, used instead of String to avoid heap allocation.
+//Text that does not fit is cut off.
+struct TextBuffer{
+  char text[TEXT_BUFFER_SIZE];
+  uint8_t length;
+
+  TextBuffer() : length(0){
+    text[0] = '\0';
+  }
+
+  const char* c_str() const{
+    return text;
+  }
+
+  TextBuffer& append(char c){
+    if(length < TEXT_BUFFER_SIZE - 1){
+      text[length++] = c;
+      text[length] = '\0';
+    }
+    return *this;
+  }
+
+  TextBuffer& append(const char* s){
+    while(*s){
+      append(*s++);
+    }
+    return *this;
+  }
+
+  //Appends a number in decimal, padded with leading zeros to at least min_digits digits:
+  TextBuffer& appendNumber(uint32_t value, uint8_t min_digits = 1){
+    char digits[10];
+    uint8_t count = 0;
+    do{
+      digits[count++] = '0' + value % 10;
+      value /= 10;
+    }while(value > 0);
+    while(count < min_digits && count < sizeof(digits)){
+      digits[count++] = '0';
+    }
+    while(count > 0){
+      append(digits[--count]);
+    }
+    return *this;
+  }
+};
+
+#endif
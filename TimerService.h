@@ -0,0 +1,117 @@
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+/*
+ * Software timers for everything the main loop does at a given time: the state's tick, going to
+ * sleep, servo steps and button repeats. A timer is a struct owned by whoever uses it, and
+ * calls its callback from runTimers() in loop() when it is due, once (one-shot) or every period
+ * (periodic). A timer without a callback just stops being active when it expires.
+ *
+ * The active timers are kept in a list sorted by due time, so runTimers() only looks at the
+ * timers that have expired and the next expiry is the head of the list. The firmware has a
+ * handful of timers, for which the list is cheaper than a timer wheel.
+ *
+ * Due times are in 64-bit milliseconds (see monotonicMillis()), which do not roll over.
+ */
+
+typedef void (*TimerCallback)();
+
+struct Timer{
+  TimerCallback callback; //Called when the timer expires (may be nullptr)
+  uint64_t due; //monotonicMillis() at which the timer expires
+  uint32_t period; //0 for a one-shot timer
+  bool active;
+  Timer* next; //Next timer in timer_list
+
+  constexpr Timer(TimerCallback callback = nullptr) : callback(callback), due(0), period(0), active(false), next(nullptr){}
+};
+
+static Timer* timer_list = nullptr; //The active timers, the earliest first
+
+//millis() extended to 64 bits. millis() rolls over after 49 days; this is called by every pass of
+//loop(), so it never misses a rollover. Deep sleep stops millis(), so it does not count sleep.
+uint64_t monotonicMillis(){
+  static uint32_t last_millis = 0;
+  static uint32_t rollovers = 0;
+  uint32_t now = millis();
+  if(now < last_millis){
+    rollovers++;
+  }
+  last_millis = now;
+  return ((uint64_t)rollovers << 32) | now;
+}
+
+//Adds a timer to timer_list, after any timers due at the same time.
+void timerInsert(Timer& timer){
+  Timer** link = &timer_list;
+  while(*link != nullptr && (*link)->due <= timer.due){
+    link = &(*link)->next;
+  }
+  timer.next = *link;
+  *link = &timer;
+  timer.active = true;
+}
+
+void timerStop(Timer& timer){
+  if(!timer.active){
+    return;
+  }
+  Timer** link = &timer_list;
+  while(*link != &timer){
+    link = &(*link)->next;
+  }
+  *link = timer.next;
+  timer.active = false;
+}
+
+//(Re)starts a timer that expires delay milliseconds from now, and every period milliseconds after that if period is not 0.
+void timerStart(Timer& timer, uint32_t delay, uint32_t period = 0){
+  timerStop(timer);
+  timer.due = monotonicMillis() + delay;
+  timer.period = period;
+  timerInsert(timer);
+}
+
+//Restarts a one-shot timer delay milliseconds after it last expired, rather than after now, so
+//a chain of these does not drift. Called from the timer's callback.
+void timerAdvance(Timer& timer, uint32_t delay){
+  timerStop(timer);
+  timer.due += delay;
+  timerInsert(timer);
+}
+
+bool timerActive(const Timer& timer){
+  return timer.active;
+}
+
+//Called from the main loop. Calls the callbacks of the timers that have expired, in order of due time.
+void runTimers(){
+  uint64_t now = monotonicMillis();
+  while(timer_list != nullptr && timer_list->due <= now){
+    Timer* timer = timer_list;
+    timer_list = timer->next;
+    timer->active = false;
+    if(timer->period != 0){
+      timer->due += timer->period;
+      if(timer->due <= now){ //Missed periods (e.g. while a callback blocked) are skipped, not made up for
+        timer->due = now + timer->period;
+      }
+      timerInsert(*timer);
+    }
+    if(timer->callback != nullptr){
+      timer->callback();
+    }
+    now = monotonicMillis();
+  }
+}
+
+//Milliseconds until the next timer expires (for idling the CPU):
+unsigned long timerNextExpiry(){
+  if(timer_list == nullptr){
+    return static_cast<unsigned long>(-1);
+  }
+  uint64_t now = monotonicMillis();
+  return timer_list->due > now ? timer_list->due - now : 0;
+}
+
+#endif
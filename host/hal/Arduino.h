@@ -0,0 +1,136 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+//Host stand-in for the Arduino core. Only the parts used by the sketch are provided.
+//Time comes from the simulator's virtual clock (see Sim.h), not from the wall clock.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+#include "Sim.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define INPUT_PULLDOWN 0x3
+
+#define CHANGE 2
+#define FALLING 3
+#define RISING 4
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t value);
+int digitalRead(uint32_t pin);
+int analogRead(uint32_t pin);
+void analogReadResolution(int bits);
+
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint32_t pin, void (*callback)(void), uint32_t mode);
+void detachInterrupt(uint32_t pin);
+void noInterrupts();
+void interrupts();
+
+template<class T> const T& min(const T& a, const T& b){ return (b < a) ? b : a; }
+template<class T> const T& max(const T& a, const T& b){ return (a < b) ? b : a; }
+
+//Minimal heap-backed String so that the original sketch code compiles unchanged.
+//Every construction is counted in sim_stats.string_allocations.
+class String{
+public:
+  String(const char* s = ""){ init(s); }
+  String(const __FlashStringHelper* s){ init(reinterpret_cast<const char*>(s)); }
+  String(const String& other){ init(other.value.c_str()); }
+  String(char c){ char s[2] = {c, 0}; init(s); }
+  String(unsigned char v){ initNumber(v); }
+  String(int v){ initNumber(v); }
+  String(unsigned int v){ initNumber(v); }
+  String(long v){ initNumber(v); }
+  String(unsigned long v){ initNumber(v); }
+  String(short v){ initNumber(v); }
+  String(unsigned short v){ initNumber(v); }
+
+  String& operator=(const String& other){ value = other.value; return *this; }
+  String& operator+=(const String& other){ value += other.value; return *this; }
+  String& operator+=(const char* s){ value += s; return *this; }
+
+  const char* c_str() const { return value.c_str(); }
+  unsigned int length() const { return value.length(); }
+  char operator[](unsigned int i) const { return i < value.length() ? value[i] : 0; }
+  long toInt() const { return strtol(value.c_str(), NULL, 10); }
+  bool operator==(const String& other) const { return value == other.value; }
+
+  friend String operator+(const String& a, const String& b){ String r(a); r.value += b.value; return r; }
+  friend String operator+(const String& a, const char* b){ String r(a); r.value += b; return r; }
+  friend String operator+(const String& a, char b){ String r(a); r.value += b; return r; }
+  friend String operator+(const String& a, unsigned char b){ return a + String(b); }
+  friend String operator+(const String& a, int b){ return a + String(b); }
+  friend String operator+(const String& a, unsigned int b){ return a + String(b); }
+  friend String operator+(const String& a, long b){ return a + String(b); }
+  friend String operator+(const String& a, unsigned long b){ return a + String(b); }
+  friend String operator+(const String& a, short b){ return a + String(b); }
+  friend String operator+(const String& a, unsigned short b){ return a + String(b); }
+  friend String operator+(const String& a, const __FlashStringHelper* b){ return a + String(b); }
+
+private:
+  std::string value;
+  void init(const char* s){ sim_stats.string_allocations++; value = s; }
+  template<class T> void initNumber(T v){ sim_stats.string_allocations++; value = std::to_string(v); }
+};
+
+//Serial stand-in. Output goes to stdout; input can be queued by the simulator script.
+class SimSerial{
+public:
+  void begin(unsigned long){}
+  operator bool() const { return sim_serial_connected; }
+  int available();
+  int read();
+  size_t write(uint8_t b);
+  size_t write(const uint8_t* data, size_t len);
+  size_t print(const char* s);
+  size_t print(const String& s){ return print(s.c_str()); }
+  size_t print(char c){ return write((uint8_t)c); }
+  size_t print(unsigned long v, int base = 10);
+  size_t print(long v, int base = 10);
+  size_t print(unsigned int v, int base = 10){ return print((unsigned long)v, base); }
+  size_t print(int v, int base = 10){ return print((long)v, base); }
+  size_t print(unsigned char v, int base = 10){ return print((unsigned long)v, base); }
+  size_t print(double v, int digits = 2);
+  template<class T> size_t println(T v){ size_t n = print(v); return n + print("\r\n"); }
+  template<class T> size_t println(T v, int base){ size_t n = print(v, base); return n + print("\r\n"); }
+  size_t println(){ return print("\r\n"); }
+  void flush(){ fflush(stdout); }
+};
+extern SimSerial Serial;
+
+#endif
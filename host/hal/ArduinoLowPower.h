@@ -0,0 +1,30 @@
+#ifndef ARDUINO_LOW_POWER_H
+#define ARDUINO_LOW_POWER_H
+
+//Host stand-in for ArduinoLowPower. Sleeping hands control back to the simulator script,
+//which advances the virtual clock until a wakeup interrupt or the timed alarm fires.
+
+#include "Arduino.h"
+
+#define RTC_ALARM_WAKEUP 0xFF
+
+typedef void (*voidFuncPtr)(void);
+typedef uint32_t irq_mode;
+
+class ArduinoLowPowerClass{
+public:
+  void idle(void);
+  void idle(uint32_t millis);
+  void idle(int millis){ idle((uint32_t)millis); }
+  void sleep(void);
+  void sleep(uint32_t millis);
+  void sleep(int millis){ sleep((uint32_t)millis); }
+  void deepSleep(void);
+  void deepSleep(uint32_t millis);
+  void deepSleep(int millis){ deepSleep((uint32_t)millis); }
+  void attachInterruptWakeup(uint32_t pin, voidFuncPtr callback, irq_mode mode);
+};
+
+extern ArduinoLowPowerClass LowPower;
+
+#endif
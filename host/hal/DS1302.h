@@ -0,0 +1,55 @@
+#ifndef DS1302_H
+#define DS1302_H
+
+//Host stand-in for the msparks DS1302 library. The clock follows the simulator's virtual
+//clock from a start date chosen by the script and keeps its 31 bytes of RAM across the run.
+
+#include "Arduino.h"
+
+class Time{
+public:
+  enum Day{
+    kSunday = 1,
+    kMonday = 2,
+    kTuesday = 3,
+    kWednesday = 4,
+    kThursday = 5,
+    kFriday = 6,
+    kSaturday = 7
+  };
+
+  Time(uint16_t yr, uint8_t mon, uint8_t date, uint8_t hr, uint8_t min, uint8_t sec, Day day)
+    : sec(sec), min(min), hr(hr), date(date), mon(mon), day(day), yr(yr){}
+
+  uint8_t sec;
+  uint8_t min;
+  uint8_t hr;
+  uint8_t date;
+  uint8_t mon;
+  Day day;
+  uint16_t yr;
+};
+
+class DS1302{
+public:
+  static const int kRamSize = 31;
+
+  DS1302(uint8_t ce_pin, uint8_t io_pin, uint8_t sclk_pin){}
+
+  void writeProtect(bool enable);
+  void halt(bool value);
+  Time time();
+  void time(Time t);
+  void writeRam(uint8_t address, uint8_t value);
+  uint8_t readRam(uint8_t address);
+  void writeRamBulk(const uint8_t* data, int len);
+  void readRamBulk(uint8_t* data, int len);
+};
+
+//Simulator controls:
+void sim_rtc_set(uint32_t unix_time); //Sets the clock to the given Unix time
+void sim_rtc_stop(bool stopped); //Freezes the clock, as with a flat clock battery
+void sim_rtc_drift(int32_t ppm); //Makes the clock run ppm faster (or slower, if negative) than the virtual clock
+void sim_rtc_corrupt_ram(); //Invalidates the battery-backed RAM
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef FLASH_STORAGE_H
+#define FLASH_STORAGE_H
+
+//Host stand-in for cmaglie/FlashStorage. The reserved arrays stay read-only; their
+//contents are shadowed by a simulated NVM that follows SAMD21 rules: rows of 256 bytes
+//erase to 0xFF and page writes can only clear bits.
+
+#include "Arduino.h"
+
+#define PPCAT_NX(A, B) A ## B
+#define PPCAT(A, B) PPCAT_NX(A, B)
+
+class FlashClass{
+public:
+  FlashClass(const void* flash_addr = NULL, uint32_t size = 0) : flash_address(flash_addr), flash_size(size){}
+
+  void write(const void* data){ write(flash_address, data, flash_size); }
+  void erase(){ erase(flash_address, flash_size); }
+  void read(void* data){ read(flash_address, data, flash_size); }
+
+  void write(const volatile void* flash_ptr, const void* data, uint32_t size);
+  void erase(const volatile void* flash_ptr, uint32_t size);
+  void read(const volatile void* flash_ptr, void* data, uint32_t size);
+
+private:
+  const volatile void* flash_address;
+  const uint32_t flash_size;
+};
+
+template<class T>
+class FlashStorageClass{
+public:
+  FlashStorageClass(const void* flash_addr) : flash(flash_addr, sizeof(T)){}
+
+  void write(T data){ flash.erase(); flash.write(&data); }
+  void read(T* data){ flash.read(data); }
+  T read(){ T data; read(&data); return data; }
+
+private:
+  FlashClass flash;
+};
+
+#define Flash(name, size) \
+  __attribute__((__aligned__(256))) \
+  static const uint8_t PPCAT(_data, name)[(size + 255) / 256 * 256] = {}; \
+  FlashClass name(PPCAT(_data, name), size);
+
+#define FlashStorage(name, T) \
+  __attribute__((__aligned__(256))) \
+  static const uint8_t PPCAT(_data, name)[(sizeof(T) + 255) / 256 * 256] = {}; \
+  FlashStorageClass<T> name(PPCAT(_data, name));
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef SERVO_H
+#define SERVO_H
+
+//Host stand-in for the Arduino Servo library.
+
+#include "Arduino.h"
+
+class Servo{
+public:
+  uint8_t attach(int pin);
+  void detach();
+  void write(int value);
+  void writeMicroseconds(int value);
+  int read();
+  bool attached();
+
+private:
+  int pin = -1;
+  int angle = 90;
+};
+
+#endif
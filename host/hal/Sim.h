@@ -0,0 +1,45 @@
+#ifndef SIM_H
+#define SIM_H
+
+//Shared state of the host simulator: the virtual clock, the counters the stand-in
+//libraries increment, and the hooks the stand-ins use to hand control back to the script.
+
+#include <stdint.h>
+
+struct SimStats{
+  uint64_t i2c_bytes; //Bytes clocked out to the display, including addressing and control bytes
+  uint64_t i2c_transactions; //Number of I2C start..stop sequences
+  uint64_t flash_page_writes; //NVM write-page commands
+  uint64_t flash_row_erases; //NVM erase-row commands
+  uint64_t rtc_reads; //DS1302 clock/calendar reads
+  uint64_t rtc_ram_transfers; //DS1302 RAM burst or single-byte transfers
+  uint64_t servo_attaches;
+  uint64_t servo_writes;
+  uint64_t string_allocations; //Arduino String objects constructed
+  uint64_t heap_allocations; //operator new / malloc calls (counted by the benchmark only)
+  uint64_t loop_iterations;
+  uint64_t awake_us; //Virtual time spent running (not in idle or sleep)
+  uint64_t idle_us; //Virtual time spent in LowPower.idle()
+  uint64_t sleep_us; //Virtual time spent in LowPower.sleep()/deepSleep()
+  uint64_t servo_powered_us; //Virtual time with SERVO_TRANSISTOR_PIN high
+  uint64_t interrupts_disabled_us; //Virtual time spent between noInterrupts() and interrupts()
+};
+
+extern SimStats sim_stats;
+extern bool sim_serial_connected;
+
+//Virtual clock, in microseconds since power-on.
+uint64_t sim_now();
+void sim_advance(uint64_t us);
+
+//Called by the LowPower stand-in. Returns once a wake source fires (or the script ends).
+void sim_idle(uint64_t max_us);
+void sim_deepSleep(uint64_t max_us);
+
+//Cost model used to advance the virtual clock for blocking peripheral operations.
+#define SIM_I2C_US_PER_BYTE 25 //400 kHz, 9 clocks per byte + overhead
+#define SIM_FLASH_ERASE_US 6000
+#define SIM_FLASH_WRITE_US 2500
+#define SIM_RTC_TRANSFER_US 300 //Bit-banged 3-wire burst
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SIM_SCRIPT_H
+#define SIM_SCRIPT_H
+
+//Script engine of the host simulator. A script is a list of commands, one per line:
+//  wait <ms>                  run the sketch for <ms> of virtual time
+//  press <button> [ms]        press a button and hold it for [ms] (default 80)
+//  hold <button> [ms]         same as press, default 1000 ms
+//  reset                      power-cycle the box (runs setup() again; flash and the clock survive),
+//                             also while it is asleep
+//  screen                     print the panel contents
+//  stats                      print the counters
+//  rtc set <unix> | stop | start | corrupt | drift <ppm>
+//  analog <pin> <value>       set the value returned by analogRead(pin)
+//  serial connect | disconnect | send <text>
+//  echo <text>
+//Lines starting with '#' are comments.
+
+#include <istream>
+
+void sim_registerButton(const char* name, int pin);
+void sim_registerServoTransistor(int pin);
+void sim_loadScript(std::istream& in);
+void sim_setEcho(bool echo);
+uint64_t sim_busyUntil();
+
+//Thrown by the `reset` command to unwind out of the sketch, wherever it is (it may be asleep
+//inside loop()). The caller of setup() and loop() catches it and runs setup() again.
+struct SimReset{};
+
+//Runs the next script command. Returns false once the script is exhausted.
+bool sim_runCommand();
+
+void sim_printStats();
+void sim_finish(); //Prints the counters and exits
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef NANO_GFX_H
+#define NANO_GFX_H
+
+//Host stand-in for the lexus2k ssd1306 library's nano_gfx.h. The sketch only includes it.
+
+#include "ssd1306.h"
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
+//Host stand-in for the lexus2k ssd1306 library (1.x C API). Drawing goes into a simulated
+//128x64 GDDRAM and every transfer is charged to sim_stats as if it went over I2C.
+
+#include "ssd1306_hal/io.h"
+
+typedef unsigned int lcduint_t;
+typedef int lcdint_t;
+
+typedef enum{
+  STYLE_NORMAL,
+  STYLE_BOLD,
+  STYLE_ITALIC,
+} EFontStyle;
+
+extern const uint8_t ssd1306xled_font6x8[];
+extern const uint8_t ssd1306xled_font8x16[];
+extern const uint8_t courier_new_font11x16_digits[];
+
+void ssd1306_128x64_i2c_init(void);
+void ssd1306_displayOn(void);
+void ssd1306_displayOff(void);
+void ssd1306_clearScreen(void);
+void ssd1306_setFixedFont(const uint8_t* progmemFont);
+uint8_t ssd1306_printFixed(uint8_t xpos, uint8_t y, const char* ch, EFontStyle style);
+lcduint_t ssd1306_getTextSize(const char* text, lcduint_t* height);
+void ssd1306_drawBitmap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* buf);
+void ssd1306_drawBuffer(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* buf);
+void ssd1306_clearBlock(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+void ssd1306_negativeMode(void);
+void ssd1306_positiveMode(void);
+void ssd1306_sendCommand(uint8_t command);
+
+//Simulator access to the panel:
+const uint8_t* sim_display_gddram(); //8 pages of 128 columns
+bool sim_display_on();
+void sim_display_print(); //ASCII dump of the panel to stdout
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef SSD1306_HAL_IO_H
+#define SSD1306_HAL_IO_H
+
+//Host stand-in for the lexus2k ssd1306 library's hardware abstraction header.
+
+#include "Arduino.h"
+
+#endif
@@ -0,0 +1,312 @@
+//Benchmarks of the sketch's clock, formatting, rendering and persistence paths, run against the
+//simulator's stand-in libraries.
+//Usage: lockbox_bench [--baseline file] [--write-baseline file]
+//
+//For each operation it reports the host time (ns/op) and what the operation costs on the box
+//according to the simulator: virtual time (the cost model in Sim.h), heap allocations, I2C bytes,
+//flash row erases and page writes, and DS1302 reads. With --baseline, the simulated figures are
+//compared with the stored ones and the program fails if any of them got worse. The host time
+//depends on the machine, so it is only reported.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "SimScript.h"
+
+#include "../../LockBoxCode.ino"
+
+//Count heap allocations made by the sketch (the firmware should make none):
+void* operator new(size_t size){
+  sim_stats.heap_allocations++;
+  void* p = malloc(size ? size : 1);
+  if(!p){
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept{
+  free(p);
+}
+
+#define BENCH_METRICS 6
+static const char* const metric_names[BENCH_METRICS] = {"virtual_us", "heap", "i2c_bytes", "flash_erases", "flash_writes", "rtc_reads"};
+
+struct BenchResult{
+  std::string name;
+  double ns;
+  double metrics[BENCH_METRICS];
+};
+
+static std::vector<BenchResult> results;
+static volatile uint32_t sink; //Keeps the compiler from dropping the benchmarked calls
+
+static void snapshot(double* values){
+  values[0] = (double)sim_now();
+  values[1] = (double)(sim_stats.heap_allocations + sim_stats.string_allocations);
+  values[2] = (double)sim_stats.i2c_bytes;
+  values[3] = (double)sim_stats.flash_row_erases;
+  values[4] = (double)sim_stats.flash_page_writes;
+  values[5] = (double)sim_stats.rtc_reads;
+}
+
+static BenchResult startResult(const char* name){
+  BenchResult result;
+  result.name = name;
+  result.ns = 0;
+  for(int m = 0; m < BENCH_METRICS; m++){
+    result.metrics[m] = 0;
+  }
+  return result;
+}
+
+static void finishResult(BenchResult& result, uint32_t iterations){
+  result.ns /= iterations;
+  for(int m = 0; m < BENCH_METRICS; m++){
+    result.metrics[m] /= iterations;
+  }
+  results.push_back(result);
+}
+
+//Runs op iterations times, with prepare (not measured) before each run.
+template<class Op, class Prepare>
+static void bench(const char* name, uint32_t iterations, Op op, Prepare prepare){
+  BenchResult result = startResult(name);
+  for(uint32_t i = 0; i < iterations; i++){
+    prepare(i);
+    double before[BENCH_METRICS], after[BENCH_METRICS];
+    snapshot(before);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    op(i);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    snapshot(after);
+    result.ns += std::chrono::duration<double, std::nano>(end - start).count();
+    for(int m = 0; m < BENCH_METRICS; m++){
+      result.metrics[m] += after[m] - before[m];
+    }
+  }
+  finishResult(result, iterations);
+}
+
+//Runs op iterations times back to back, timing the whole run, so that the clock reads do not
+//swamp operations that take a few nanoseconds.
+template<class Op>
+static void bench(const char* name, uint32_t iterations, Op op){
+  BenchResult result = startResult(name);
+  double before[BENCH_METRICS], after[BENCH_METRICS];
+  snapshot(before);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(uint32_t i = 0; i < iterations; i++){
+    op(i);
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  snapshot(after);
+  result.ns = std::chrono::duration<double, std::nano>(end - start).count();
+  for(int m = 0; m < BENCH_METRICS; m++){
+    result.metrics[m] = after[m] - before[m];
+  }
+  finishResult(result, iterations);
+}
+
+//Measures going from one state to another, including drawing and flushing the new state's screen.
+static void benchTransition(const char* name, uint8_t from, uint8_t to){
+  bench(name, 20, [to](uint32_t){
+    transferTo(to);
+    renderFrame();
+    fb_flush();
+  }, [from](uint32_t){
+    transferTo(from);
+    renderFrame();
+    fb_flush();
+  });
+}
+
+static void runBenchmarks(){
+  //Clock and formatting:
+  Time t(2021, 8, 21, 12, 34, 56, Time::kSaturday);
+  bench("time_to_timestamp", 10000, [&t](uint32_t){ sink += time_to_timestamp(t); });
+  bench("timestampToTime", 10000, [](uint32_t i){ sink += timestampToTime(1629547200 + i * 3607).date; });
+  bench("timeAsString", 10000, [&t](uint32_t){ sink += timeAsString(t).length; });
+  bench("spanAsString", 10000, [](uint32_t i){ sink += spanAsString(spanFromSeconds(86400 + i)).length; });
+  bench("currentTimestamp", 1000, [](uint32_t){ sink += currentTimestamp(); }, [](uint32_t){ invalidateClock(); });
+
+  //Combination codec:
+  uint8_t digits[COMBO_LENGTH] = {0};
+  bench("packCombo", 10000, [&digits](uint32_t i){
+    digits[i % COMBO_LENGTH] = i % 10;
+    sink += (uint32_t)packCombo(digits);
+  });
+  bench("comboEquals", 10000, [](uint32_t i){ sink += comboEquals(i, 123456); });
+
+  //Rendering:
+  transferTo(LOCKED_STATE_ID);
+  renderFrame();
+  fb_flush();
+  bench("printCombo_full", 100, [](uint32_t){
+    __LockedScreen.printCombo();
+    fb_flush();
+  }, [](uint32_t){
+    fb_clearScreen();
+    fb_flush();
+  });
+  bench("locked_digit_up", 100, [](uint32_t){
+    __LockedScreen.upButton();
+    renderFrame();
+    fb_flush();
+  });
+  bench("locked_digit_burst", 100, [](uint32_t){ //Five presses before the next frame
+    for(int press = 0; press < 5; press++){
+      __LockedScreen.upButton();
+    }
+    renderFrame();
+    fb_flush();
+  });
+  benchTransition("unlocked_to_setcombo", UNLOCKED_STATE_ID, SETCOMBO_STATE_ID);
+  benchTransition("unlocked_to_setduration", UNLOCKED_STATE_ID, SET_DURATION_STATE_ID);
+  benchTransition("unlocked_to_locked", UNLOCKED_STATE_ID, LOCKED_STATE_ID);
+  benchTransition("unlocked_to_diagnostics", UNLOCKED_STATE_ID, DIAGNOSTICS_STATE_ID);
+  benchTransition("diagnostics_to_history", DIAGNOSTICS_STATE_ID, HISTORY_STATE_ID);
+  benchTransition("setcombo_to_unlocked", SETCOMBO_STATE_ID, UNLOCKED_STATE_ID);
+
+  //Persistence:
+  bench("storeState", 64, [](uint32_t){ //Alternates, as storing the current state again writes nothing
+    storeState(stored.state_id == LOCKED_STATE_ID ? UNLOCKED_STATE_ID : LOCKED_STATE_ID);
+  });
+  bench("storeTimeLock", 64, [](uint32_t i){
+    storeTimeLock(1629547200 + i, 1629547200 + i + 3600);
+  });
+  storeState(UNLOCKED_STATE_ID);
+  bench("audit", 256, [](uint32_t){
+    audit(AUDIT_WRONG_PIN);
+  }, [](uint32_t){ //The spare row is erased from a timer, outside the measured path
+    if(timerActive(audit_erase_timer)){
+      timerStop(audit_erase_timer);
+      auditMaintain();
+    }
+  });
+  bench("auditFind", 1000, [](uint32_t i){ sink += auditFind(1629547200 + i); });
+}
+
+static void printResults(){
+  printf("%-26s %10s", "benchmark", "ns/op");
+  for(int m = 0; m < BENCH_METRICS; m++){
+    printf(" %12s", metric_names[m]);
+  }
+  printf("\n");
+  for(size_t i = 0; i < results.size(); i++){
+    printf("%-26s %10.1f", results[i].name.c_str(), results[i].ns);
+    for(int m = 0; m < BENCH_METRICS; m++){
+      printf(" %12.3f", results[i].metrics[m]);
+    }
+    printf("\n");
+  }
+}
+
+//Baseline file: one line per benchmark, the name followed by the simulated figures.
+static bool writeBaseline(const char* path){
+  std::ofstream file(path);
+  if(!file){
+    return false;
+  }
+  file << "#benchmark";
+  for(int m = 0; m < BENCH_METRICS; m++){
+    file << ' ' << metric_names[m];
+  }
+  file << '\n';
+  char value[32];
+  for(size_t i = 0; i < results.size(); i++){
+    file << results[i].name;
+    for(int m = 0; m < BENCH_METRICS; m++){
+      snprintf(value, sizeof(value), " %.3f", results[i].metrics[m]);
+      file << value;
+    }
+    file << '\n';
+  }
+  return true;
+}
+
+//Returns the number of regressions.
+static int compareBaseline(std::istream& in){
+  std::map<std::string, std::vector<double> > baseline;
+  std::string line;
+  while(std::getline(in, line)){
+    if(line.empty() || line[0] == '#'){
+      continue;
+    }
+    std::istringstream words(line);
+    std::string name;
+    words >> name;
+    std::vector<double> values(BENCH_METRICS, 0);
+    for(int m = 0; m < BENCH_METRICS; m++){
+      words >> values[m];
+    }
+    baseline[name] = values;
+  }
+
+  int regressions = 0;
+  for(size_t i = 0; i < results.size(); i++){
+    std::map<std::string, std::vector<double> >::iterator it = baseline.find(results[i].name);
+    if(it == baseline.end()){
+      printf("NEW  %s (not in the baseline)\n", results[i].name.c_str());
+      continue;
+    }
+    for(int m = 0; m < BENCH_METRICS; m++){
+      double stored = it->second[m];
+      double measured = results[i].metrics[m];
+      if(measured > stored + 0.0005){
+        printf("FAIL %s %s: %.3f, baseline %.3f\n", results[i].name.c_str(), metric_names[m], measured, stored);
+        regressions++;
+      }else if(measured < stored - 0.0005){
+        printf("GAIN %s %s: %.3f, baseline %.3f\n", results[i].name.c_str(), metric_names[m], measured, stored);
+      }
+    }
+  }
+  return regressions;
+}
+
+int main(int argc, char** argv){
+  const char* baseline_path = NULL;
+  const char* write_path = NULL;
+  for(int i = 1; i + 1 < argc; i += 2){
+    if(strcmp(argv[i], "--baseline") == 0){
+      baseline_path = argv[i + 1];
+    }else if(strcmp(argv[i], "--write-baseline") == 0){
+      write_path = argv[i + 1];
+    }else{
+      fprintf(stderr, "usage: lockbox_bench [--baseline file] [--write-baseline file]\n");
+      return 2;
+    }
+  }
+
+  std::istringstream no_script("");
+  sim_loadScript(no_script);
+  setup();
+  runBenchmarks();
+  printResults();
+
+  if(write_path && !writeBaseline(write_path)){
+    fprintf(stderr, "bench: cannot write %s\n", write_path);
+    return 2;
+  }
+  if(baseline_path){
+    std::ifstream file(baseline_path);
+    if(!file){
+      fprintf(stderr, "bench: cannot open %s\n", baseline_path);
+      return 2;
+    }
+    int regressions = compareBaseline(file);
+    if(regressions > 0){
+      printf("%d regression(s) against %s\n", regressions, baseline_path);
+      return 1;
+    }
+    printf("No regressions against %s\n", baseline_path);
+  }
+  return 0;
+}
@@ -0,0 +1,225 @@
+//Placeholder fonts for the host simulator. They have the same header and glyph layout as
+//the lexus2k ssd1306 fixed fonts (type, width, height, first character, then page-major
+//column bytes per glyph), but the glyph shapes are synthetic: only sizes and transfer
+//costs are meaningful.
+
+#include "ssd1306.h"
+
+const uint8_t ssd1306xled_font6x8[] PROGMEM = {
+0x00, 0x06, 0x08, 0x20, //6x8, ' ' to DEL
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //' '
+0xB5, 0x60, 0x61, 0x61, 0xB5, 0x00, //'!'
+0xF1, 0x53, 0x54, 0x55, 0xF1, 0x00, //'"'
+0xAD, 0x47, 0x47, 0x48, 0xAD, 0x00, //'#'
+0xE9, 0x3A, 0x3B, 0x3C, 0xE9, 0x00, //'$'
+0xA5, 0x2D, 0x2E, 0x2F, 0xA5, 0x00, //'%'
+0xE1, 0x21, 0x22, 0x22, 0xE1, 0x00, //'&'
+0x9D, 0x14, 0x15, 0x16, 0x9D, 0x00, //'''
+0xD9, 0x08, 0x08, 0x09, 0xD9, 0x00, //'('
+0x93, 0xFB, 0xFC, 0xFC, 0x93, 0x00, //')'
+0xCF, 0xEE, 0xEF, 0xF0, 0xCF, 0x00, //'*'
+0x8B, 0xE2, 0xE2, 0xE3, 0x8B, 0x00, //'+'
+0xC7, 0xD5, 0xD6, 0xD7, 0xC7, 0x00, //','
+0x83, 0xC8, 0xC9, 0xCA, 0x83, 0x00, //'-'
+0xBF, 0xBC, 0xBD, 0xBD, 0xBF, 0x00, //'.'
+0xFB, 0xAF, 0xB0, 0xB1, 0xFB, 0x00, //'/'
+0xB7, 0xA3, 0xA3, 0xA4, 0xB7, 0x00, //'0'
+0xF3, 0x96, 0x97, 0x98, 0xF3, 0x00, //'1'
+0xAF, 0x89, 0x8A, 0x8B, 0xAF, 0x00, //'2'
+0xE9, 0x7D, 0x7E, 0x7E, 0xE9, 0x00, //'3'
+0xA5, 0x70, 0x71, 0x72, 0xA5, 0x00, //'4'
+0xE1, 0x64, 0x64, 0x65, 0xE1, 0x00, //'5'
+0x9D, 0x57, 0x58, 0x58, 0x9D, 0x00, //'6'
+0xD9, 0x4A, 0x4B, 0x4C, 0xD9, 0x00, //'7'
+0x95, 0x3E, 0x3E, 0x3F, 0x95, 0x00, //'8'
+0xD1, 0x31, 0x32, 0x33, 0xD1, 0x00, //'9'
+0x8D, 0x24, 0x25, 0x26, 0x8D, 0x00, //':'
+0xC9, 0x18, 0x19, 0x19, 0xC9, 0x00, //';'
+0x85, 0x0B, 0x0C, 0x0D, 0x85, 0x00, //'<'
+0xBF, 0xFF, 0xFF, 0x00, 0xC1, 0x00, //'='
+0xFB, 0xF2, 0xF3, 0xF4, 0xFB, 0x00, //'>'
+0xB7, 0xE5, 0xE6, 0xE7, 0xB7, 0x00, //'?'
+0xF3, 0xD9, 0xDA, 0xDA, 0xF3, 0x00, //'@'
+0xAF, 0xCC, 0xCD, 0xCE, 0xAF, 0x00, //'A'
+0xEB, 0xC0, 0xC0, 0xC1, 0xEB, 0x00, //'B'
+0xA7, 0xB3, 0xB4, 0xB4, 0xA7, 0x00, //'C'
+0xE3, 0xA6, 0xA7, 0xA8, 0xE3, 0x00, //'D'
+0x9F, 0x9A, 0x9A, 0x9B, 0x9F, 0x00, //'E'
+0xDB, 0x8D, 0x8E, 0x8F, 0xDB, 0x00, //'F'
+0x97, 0x80, 0x81, 0x82, 0x97, 0x00, //'G'
+0xD1, 0x74, 0x75, 0x75, 0xD1, 0x00, //'H'
+0x8D, 0x67, 0x68, 0x69, 0x8D, 0x00, //'I'
+0xC9, 0x5B, 0x5B, 0x5C, 0xC9, 0x00, //'J'
+0x85, 0x4E, 0x4F, 0x4F, 0x85, 0x00, //'K'
+0xC1, 0x41, 0x42, 0x43, 0xC1, 0x00, //'L'
+0xFD, 0x35, 0x35, 0x36, 0xFD, 0x00, //'M'
+0xB9, 0x28, 0x29, 0x2A, 0xB9, 0x00, //'N'
+0xF5, 0x1C, 0x1C, 0x1D, 0xF5, 0x00, //'O'
+0xB1, 0x0F, 0x10, 0x10, 0xB1, 0x00, //'P'
+0xED, 0x02, 0x03, 0x04, 0xED, 0x00, //'Q'
+0xA7, 0xF6, 0xF6, 0xF7, 0xA7, 0x00, //'R'
+0xE3, 0xE9, 0xEA, 0xEB, 0xE3, 0x00, //'S'
+0x9F, 0xDC, 0xDD, 0xDE, 0x9F, 0x00, //'T'
+0xDB, 0xD0, 0xD1, 0xD1, 0xDB, 0x00, //'U'
+0x97, 0xC3, 0xC4, 0xC5, 0x97, 0x00, //'V'
+0xD3, 0xB7, 0xB7, 0xB8, 0xD3, 0x00, //'W'
+0x8F, 0xAA, 0xAB, 0xAB, 0x8F, 0x00, //'X'
+0xCB, 0x9D, 0x9E, 0x9F, 0xCB, 0x00, //'Y'
+0x87, 0x91, 0x91, 0x92, 0x87, 0x00, //'Z'
+0xC3, 0x84, 0x85, 0x86, 0xC3, 0x00, //'['
+0xFD, 0x77, 0x78, 0x79, 0xFD, 0x00, //'backslash'
+0xB9, 0x6B, 0x6C, 0x6C, 0xB9, 0x00, //']'
+0xF5, 0x5E, 0x5F, 0x60, 0xF5, 0x00, //'^'
+0xB1, 0x52, 0x52, 0x53, 0xB1, 0x00, //'_'
+0xED, 0x45, 0x46, 0x47, 0xED, 0x00, //'`'
+0xA9, 0x38, 0x39, 0x3A, 0xA9, 0x00, //'a'
+0xE5, 0x2C, 0x2D, 0x2D, 0xE5, 0x00, //'b'
+0xA1, 0x1F, 0x20, 0x21, 0xA1, 0x00, //'c'
+0xDD, 0x13, 0x13, 0x14, 0xDD, 0x00, //'d'
+0x99, 0x06, 0x07, 0x07, 0x99, 0x00, //'e'
+0xD3, 0xF9, 0xFA, 0xFB, 0xD3, 0x00, //'f'
+0x8F, 0xED, 0xED, 0xEE, 0x8F, 0x00, //'g'
+0xCB, 0xE0, 0xE1, 0xE2, 0xCB, 0x00, //'h'
+0x87, 0xD3, 0xD4, 0xD5, 0x87, 0x00, //'i'
+0xC3, 0xC7, 0xC8, 0xC8, 0xC3, 0x00, //'j'
+0xFF, 0xBA, 0xBB, 0xBC, 0xFF, 0x00, //'k'
+0xBB, 0xAE, 0xAE, 0xAF, 0xBB, 0x00, //'l'
+0xF7, 0xA1, 0xA2, 0xA3, 0xF7, 0x00, //'m'
+0xB3, 0x94, 0x95, 0x96, 0xB3, 0x00, //'n'
+0xEF, 0x88, 0x89, 0x89, 0xEF, 0x00, //'o'
+0xA9, 0x7B, 0x7C, 0x7D, 0xA9, 0x00, //'p'
+0xE5, 0x6F, 0x6F, 0x70, 0xE5, 0x00, //'q'
+0xA1, 0x62, 0x63, 0x63, 0xA1, 0x00, //'r'
+0xDD, 0x55, 0x56, 0x57, 0xDD, 0x00, //'s'
+0x99, 0x49, 0x49, 0x4A, 0x99, 0x00, //'t'
+0xD5, 0x3C, 0x3D, 0x3E, 0xD5, 0x00, //'u'
+0x91, 0x2F, 0x30, 0x31, 0x91, 0x00, //'v'
+0xCD, 0x23, 0x24, 0x24, 0xCD, 0x00, //'w'
+0x89, 0x16, 0x17, 0x18, 0x89, 0x00, //'x'
+0xC5, 0x0A, 0x0A, 0x0B, 0xC5, 0x00, //'y'
+0xFF, 0xFD, 0xFE, 0xFE, 0xFF, 0x00, //'z'
+0xBB, 0xF0, 0xF1, 0xF2, 0xBB, 0x00, //'{'
+0xF7, 0xE4, 0xE4, 0xE5, 0xF7, 0x00, //'|'
+0xB3, 0xD7, 0xD8, 0xD9, 0xB3, 0x00, //'}'
+0xEF, 0xCA, 0xCB, 0xCC, 0xEF, 0x00, //'~'
+0xAB, 0xBE, 0xBF, 0xBF, 0xAB, 0x00, //''
+};
+
+const uint8_t ssd1306xled_font8x16[] PROGMEM = {
+0x00, 0x08, 0x10, 0x20, //8x16, ' ' to DEL
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //' '
+0xB5, 0x60, 0x61, 0x61, 0x62, 0x63, 0xB5, 0x00, 0xBB, 0x9C, 0x9D, 0x9E, 0x9F, 0x9F, 0xBB, 0x00, //'!'
+0xF1, 0x53, 0x54, 0x55, 0x56, 0x56, 0xF1, 0x00, 0xF7, 0x90, 0x90, 0x91, 0x92, 0x93, 0xF7, 0x00, //'"'
+0xAD, 0x47, 0x47, 0x48, 0x49, 0x4A, 0xAD, 0x00, 0xB3, 0x83, 0x84, 0x85, 0x85, 0x86, 0xB3, 0x00, //'#'
+0xE9, 0x3A, 0x3B, 0x3C, 0x3C, 0x3D, 0xE9, 0x00, 0xED, 0x76, 0x77, 0x78, 0x79, 0x7A, 0xED, 0x00, //'$'
+0xA5, 0x2D, 0x2E, 0x2F, 0x30, 0x30, 0xA5, 0x00, 0xA9, 0x6A, 0x6B, 0x6B, 0x6C, 0x6D, 0xA9, 0x00, //'%'
+0xE1, 0x21, 0x22, 0x22, 0x23, 0x24, 0xE1, 0x00, 0xE5, 0x5D, 0x5E, 0x5F, 0x60, 0x60, 0xE5, 0x00, //'&'
+0x9D, 0x14, 0x15, 0x16, 0x16, 0x17, 0x9D, 0x00, 0xA1, 0x51, 0x51, 0x52, 0x53, 0x54, 0xA1, 0x00, //'''
+0xD9, 0x08, 0x08, 0x09, 0x0A, 0x0B, 0xD9, 0x00, 0xDD, 0x44, 0x45, 0x46, 0x46, 0x47, 0xDD, 0x00, //'('
+0x93, 0xFB, 0xFC, 0xFC, 0xFD, 0xFE, 0x93, 0x00, 0x99, 0x37, 0x38, 0x39, 0x3A, 0x3A, 0x99, 0x00, //')'
+0xCF, 0xEE, 0xEF, 0xF0, 0xF1, 0xF1, 0xCF, 0x00, 0xD5, 0x2B, 0x2C, 0x2C, 0x2D, 0x2E, 0xD5, 0x00, //'*'
+0x8B, 0xE2, 0xE2, 0xE3, 0xE4, 0xE5, 0x8B, 0x00, 0x91, 0x1E, 0x1F, 0x20, 0x20, 0x21, 0x91, 0x00, //'+'
+0xC7, 0xD5, 0xD6, 0xD7, 0xD7, 0xD8, 0xC7, 0x00, 0xCD, 0x12, 0x12, 0x13, 0x14, 0x15, 0xCD, 0x00, //','
+0x83, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0x83, 0x00, 0x89, 0x05, 0x06, 0x06, 0x07, 0x08, 0x89, 0x00, //'-'
+0xBF, 0xBC, 0xBD, 0xBD, 0xBE, 0xBF, 0xBF, 0x00, 0xC3, 0xF8, 0xF9, 0xFA, 0xFB, 0xFB, 0xC3, 0x00, //'.'
+0xFB, 0xAF, 0xB0, 0xB1, 0xB2, 0xB2, 0xFB, 0x00, 0xFF, 0xEC, 0xEC, 0xED, 0xEE, 0xEF, 0xFF, 0x00, //'/'
+0xB7, 0xA3, 0xA3, 0xA4, 0xA5, 0xA6, 0xB7, 0x00, 0xBB, 0xDF, 0xE0, 0xE1, 0xE1, 0xE2, 0xBB, 0x00, //'0'
+0xF3, 0x96, 0x97, 0x98, 0x98, 0x99, 0xF3, 0x00, 0xF7, 0xD2, 0xD3, 0xD4, 0xD5, 0xD5, 0xF7, 0x00, //'1'
+0xAF, 0x89, 0x8A, 0x8B, 0x8C, 0x8C, 0xAF, 0x00, 0xB3, 0xC6, 0xC7, 0xC7, 0xC8, 0xC9, 0xB3, 0x00, //'2'
+0xE9, 0x7D, 0x7E, 0x7E, 0x7F, 0x80, 0xEB, 0x00, 0xEF, 0xB9, 0xBA, 0xBB, 0xBB, 0xBC, 0xEF, 0x00, //'3'
+0xA5, 0x70, 0x71, 0x72, 0x72, 0x73, 0xA5, 0x00, 0xAB, 0xAD, 0xAD, 0xAE, 0xAF, 0xB0, 0xAB, 0x00, //'4'
+0xE1, 0x64, 0x64, 0x65, 0x66, 0x67, 0xE1, 0x00, 0xE7, 0xA0, 0xA1, 0xA1, 0xA2, 0xA3, 0xE7, 0x00, //'5'
+0x9D, 0x57, 0x58, 0x58, 0x59, 0x5A, 0x9D, 0x00, 0xA3, 0x93, 0x94, 0x95, 0x96, 0x96, 0xA3, 0x00, //'6'
+0xD9, 0x4A, 0x4B, 0x4C, 0x4D, 0x4D, 0xD9, 0x00, 0xDF, 0x87, 0x88, 0x88, 0x89, 0x8A, 0xDF, 0x00, //'7'
+0x95, 0x3E, 0x3E, 0x3F, 0x40, 0x41, 0x95, 0x00, 0x99, 0x7A, 0x7B, 0x7C, 0x7C, 0x7D, 0x99, 0x00, //'8'
+0xD1, 0x31, 0x32, 0x33, 0x33, 0x34, 0xD1, 0x00, 0xD5, 0x6E, 0x6E, 0x6F, 0x70, 0x71, 0xD5, 0x00, //'9'
+0x8D, 0x24, 0x25, 0x26, 0x27, 0x27, 0x8D, 0x00, 0x91, 0x61, 0x62, 0x62, 0x63, 0x64, 0x91, 0x00, //':'
+0xC9, 0x18, 0x19, 0x19, 0x1A, 0x1B, 0xC9, 0x00, 0xCD, 0x54, 0x55, 0x56, 0x57, 0x57, 0xCD, 0x00, //';'
+0x85, 0x0B, 0x0C, 0x0D, 0x0E, 0x0E, 0x85, 0x00, 0x89, 0x48, 0x48, 0x49, 0x4A, 0x4B, 0x89, 0x00, //'<'
+0xBF, 0xFF, 0xFF, 0x00, 0x01, 0x02, 0xC1, 0x00, 0xC5, 0x3B, 0x3C, 0x3D, 0x3D, 0x3E, 0xC5, 0x00, //'='
+0xFB, 0xF2, 0xF3, 0xF4, 0xF4, 0xF5, 0xFB, 0x00, 0x81, 0x2E, 0x2F, 0x30, 0x31, 0x31, 0x81, 0x00, //'>'
+0xB7, 0xE5, 0xE6, 0xE7, 0xE8, 0xE8, 0xB7, 0x00, 0xBD, 0x22, 0x23, 0x23, 0x24, 0x25, 0xBD, 0x00, //'?'
+0xF3, 0xD9, 0xDA, 0xDA, 0xDB, 0xDC, 0xF3, 0x00, 0xF9, 0x15, 0x16, 0x17, 0x17, 0x18, 0xF9, 0x00, //'@'
+0xAF, 0xCC, 0xCD, 0xCE, 0xCE, 0xCF, 0xAF, 0x00, 0xB5, 0x09, 0x09, 0x0A, 0x0B, 0x0C, 0xB5, 0x00, //'A'
+0xEB, 0xC0, 0xC0, 0xC1, 0xC2, 0xC3, 0xEB, 0x00, 0xEF, 0xFC, 0xFD, 0xFD, 0xFE, 0xFF, 0xF1, 0x00, //'B'
+0xA7, 0xB3, 0xB4, 0xB4, 0xB5, 0xB6, 0xA7, 0x00, 0xAB, 0xEF, 0xF0, 0xF1, 0xF2, 0xF2, 0xAB, 0x00, //'C'
+0xE3, 0xA6, 0xA7, 0xA8, 0xA9, 0xA9, 0xE3, 0x00, 0xE7, 0xE3, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0x00, //'D'
+0x9F, 0x9A, 0x9A, 0x9B, 0x9C, 0x9D, 0x9F, 0x00, 0xA3, 0xD6, 0xD7, 0xD8, 0xD8, 0xD9, 0xA3, 0x00, //'E'
+0xDB, 0x8D, 0x8E, 0x8F, 0x8F, 0x90, 0xDB, 0x00, 0xDF, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xDF, 0x00, //'F'
+0x97, 0x80, 0x81, 0x82, 0x83, 0x83, 0x97, 0x00, 0x9B, 0xBD, 0xBE, 0xBE, 0xBF, 0xC0, 0x9B, 0x00, //'G'
+0xD1, 0x74, 0x75, 0x75, 0x76, 0x77, 0xD1, 0x00, 0xD7, 0xB0, 0xB1, 0xB2, 0xB3, 0xB3, 0xD7, 0x00, //'H'
+0x8D, 0x67, 0x68, 0x69, 0x69, 0x6A, 0x8D, 0x00, 0x93, 0xA4, 0xA4, 0xA5, 0xA6, 0xA7, 0x93, 0x00, //'I'
+0xC9, 0x5B, 0x5B, 0x5C, 0x5D, 0x5E, 0xC9, 0x00, 0xCF, 0x97, 0x98, 0x99, 0x99, 0x9A, 0xCF, 0x00, //'J'
+0x85, 0x4E, 0x4F, 0x4F, 0x50, 0x51, 0x85, 0x00, 0x8B, 0x8A, 0x8B, 0x8C, 0x8D, 0x8D, 0x8B, 0x00, //'K'
+0xC1, 0x41, 0x42, 0x43, 0x44, 0x44, 0xC1, 0x00, 0xC5, 0x7E, 0x7F, 0x7F, 0x80, 0x81, 0xC7, 0x00, //'L'
+0xFD, 0x35, 0x35, 0x36, 0x37, 0x38, 0xFD, 0x00, 0x81, 0x71, 0x72, 0x73, 0x73, 0x74, 0x81, 0x00, //'M'
+0xB9, 0x28, 0x29, 0x2A, 0x2A, 0x2B, 0xB9, 0x00, 0xBD, 0x65, 0x65, 0x66, 0x67, 0x68, 0xBD, 0x00, //'N'
+0xF5, 0x1C, 0x1C, 0x1D, 0x1E, 0x1F, 0xF5, 0x00, 0xF9, 0x58, 0x59, 0x59, 0x5A, 0x5B, 0xF9, 0x00, //'O'
+0xB1, 0x0F, 0x10, 0x10, 0x11, 0x12, 0xB1, 0x00, 0xB5, 0x4B, 0x4C, 0x4D, 0x4E, 0x4E, 0xB5, 0x00, //'P'
+0xED, 0x02, 0x03, 0x04, 0x05, 0x05, 0xED, 0x00, 0xF1, 0x3F, 0x3F, 0x40, 0x41, 0x42, 0xF1, 0x00, //'Q'
+0xA7, 0xF6, 0xF6, 0xF7, 0xF8, 0xF9, 0xA7, 0x00, 0xAD, 0x32, 0x33, 0x34, 0x34, 0x35, 0xAD, 0x00, //'R'
+0xE3, 0xE9, 0xEA, 0xEB, 0xEB, 0xEC, 0xE3, 0x00, 0xE9, 0x25, 0x26, 0x27, 0x28, 0x28, 0xE9, 0x00, //'S'
+0x9F, 0xDC, 0xDD, 0xDE, 0xDF, 0xDF, 0x9F, 0x00, 0xA5, 0x19, 0x1A, 0x1A, 0x1B, 0x1C, 0xA5, 0x00, //'T'
+0xDB, 0xD0, 0xD1, 0xD1, 0xD2, 0xD3, 0xDB, 0x00, 0xE1, 0x0C, 0x0D, 0x0E, 0x0F, 0x0F, 0xE1, 0x00, //'U'
+0x97, 0xC3, 0xC4, 0xC5, 0xC5, 0xC6, 0x97, 0x00, 0x9B, 0x00, 0x00, 0x01, 0x02, 0x03, 0x9D, 0x00, //'V'
+0xD3, 0xB7, 0xB7, 0xB8, 0xB9, 0xBA, 0xD3, 0x00, 0xD7, 0xF3, 0xF4, 0xF5, 0xF5, 0xF6, 0xD7, 0x00, //'W'
+0x8F, 0xAA, 0xAB, 0xAB, 0xAC, 0xAD, 0x8F, 0x00, 0x93, 0xE6, 0xE7, 0xE8, 0xE9, 0xE9, 0x93, 0x00, //'X'
+0xCB, 0x9D, 0x9E, 0x9F, 0xA0, 0xA0, 0xCB, 0x00, 0xCF, 0xDA, 0xDB, 0xDB, 0xDC, 0xDD, 0xCF, 0x00, //'Y'
+0x87, 0x91, 0x91, 0x92, 0x93, 0x94, 0x87, 0x00, 0x8B, 0xCD, 0xCE, 0xCF, 0xCF, 0xD0, 0x8B, 0x00, //'Z'
+0xC3, 0x84, 0x85, 0x86, 0x86, 0x87, 0xC3, 0x00, 0xC7, 0xC1, 0xC1, 0xC2, 0xC3, 0xC4, 0xC7, 0x00, //'['
+0xFD, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0xFD, 0x00, 0x83, 0xB4, 0xB5, 0xB5, 0xB6, 0xB7, 0x83, 0x00, //'backslash'
+0xB9, 0x6B, 0x6C, 0x6C, 0x6D, 0x6E, 0xB9, 0x00, 0xBF, 0xA7, 0xA8, 0xA9, 0xAA, 0xAA, 0xBF, 0x00, //']'
+0xF5, 0x5E, 0x5F, 0x60, 0x61, 0x61, 0xF5, 0x00, 0xFB, 0x9B, 0x9B, 0x9C, 0x9D, 0x9E, 0xFB, 0x00, //'^'
+0xB1, 0x52, 0x52, 0x53, 0x54, 0x55, 0xB1, 0x00, 0xB7, 0x8E, 0x8F, 0x90, 0x90, 0x91, 0xB7, 0x00, //'_'
+0xED, 0x45, 0x46, 0x47, 0x47, 0x48, 0xED, 0x00, 0xF3, 0x81, 0x82, 0x83, 0x84, 0x84, 0xF3, 0x00, //'`'
+0xA9, 0x38, 0x39, 0x3A, 0x3B, 0x3B, 0xA9, 0x00, 0xAD, 0x75, 0x76, 0x76, 0x77, 0x78, 0xAD, 0x00, //'a'
+0xE5, 0x2C, 0x2D, 0x2D, 0x2E, 0x2F, 0xE5, 0x00, 0xE9, 0x68, 0x69, 0x6A, 0x6A, 0x6B, 0xE9, 0x00, //'b'
+0xA1, 0x1F, 0x20, 0x21, 0x21, 0x22, 0xA1, 0x00, 0xA5, 0x5C, 0x5C, 0x5D, 0x5E, 0x5F, 0xA5, 0x00, //'c'
+0xDD, 0x13, 0x13, 0x14, 0x15, 0x16, 0xDD, 0x00, 0xE1, 0x4F, 0x50, 0x50, 0x51, 0x52, 0xE1, 0x00, //'d'
+0x99, 0x06, 0x07, 0x07, 0x08, 0x09, 0x99, 0x00, 0x9D, 0x42, 0x43, 0x44, 0x45, 0x45, 0x9D, 0x00, //'e'
+0xD3, 0xF9, 0xFA, 0xFB, 0xFC, 0xFC, 0xD3, 0x00, 0xD9, 0x36, 0x36, 0x37, 0x38, 0x39, 0xD9, 0x00, //'f'
+0x8F, 0xED, 0xED, 0xEE, 0xEF, 0xF0, 0x8F, 0x00, 0x95, 0x29, 0x2A, 0x2B, 0x2B, 0x2C, 0x95, 0x00, //'g'
+0xCB, 0xE0, 0xE1, 0xE2, 0xE2, 0xE3, 0xCB, 0x00, 0xD1, 0x1D, 0x1D, 0x1E, 0x1F, 0x20, 0xD1, 0x00, //'h'
+0x87, 0xD3, 0xD4, 0xD5, 0xD6, 0xD6, 0x87, 0x00, 0x8D, 0x10, 0x11, 0x11, 0x12, 0x13, 0x8D, 0x00, //'i'
+0xC3, 0xC7, 0xC8, 0xC8, 0xC9, 0xCA, 0xC3, 0x00, 0xC9, 0x03, 0x04, 0x05, 0x06, 0x06, 0xC9, 0x00, //'j'
+0xFF, 0xBA, 0xBB, 0xBC, 0xBC, 0xBD, 0xFF, 0x00, 0x83, 0xF7, 0xF7, 0xF8, 0xF9, 0xFA, 0x83, 0x00, //'k'
+0xBB, 0xAE, 0xAE, 0xAF, 0xB0, 0xB1, 0xBB, 0x00, 0xBF, 0xEA, 0xEB, 0xEC, 0xEC, 0xED, 0xBF, 0x00, //'l'
+0xF7, 0xA1, 0xA2, 0xA3, 0xA3, 0xA4, 0xF7, 0x00, 0xFB, 0xDD, 0xDE, 0xDF, 0xE0, 0xE0, 0xFB, 0x00, //'m'
+0xB3, 0x94, 0x95, 0x96, 0x97, 0x97, 0xB3, 0x00, 0xB7, 0xD1, 0xD2, 0xD2, 0xD3, 0xD4, 0xB7, 0x00, //'n'
+0xEF, 0x88, 0x89, 0x89, 0x8A, 0x8B, 0xEF, 0x00, 0xF3, 0xC4, 0xC5, 0xC6, 0xC6, 0xC7, 0xF3, 0x00, //'o'
+0xA9, 0x7B, 0x7C, 0x7D, 0x7D, 0x7E, 0xA9, 0x00, 0xAF, 0xB8, 0xB8, 0xB9, 0xBA, 0xBB, 0xAF, 0x00, //'p'
+0xE5, 0x6F, 0x6F, 0x70, 0x71, 0x72, 0xE5, 0x00, 0xEB, 0xAB, 0xAC, 0xAC, 0xAD, 0xAE, 0xEB, 0x00, //'q'
+0xA1, 0x62, 0x63, 0x63, 0x64, 0x65, 0xA1, 0x00, 0xA7, 0x9E, 0x9F, 0xA0, 0xA1, 0xA1, 0xA7, 0x00, //'r'
+0xDD, 0x55, 0x56, 0x57, 0x58, 0x58, 0xDD, 0x00, 0xE3, 0x92, 0x92, 0x93, 0x94, 0x95, 0xE3, 0x00, //'s'
+0x99, 0x49, 0x49, 0x4A, 0x4B, 0x4C, 0x99, 0x00, 0x9F, 0x85, 0x86, 0x87, 0x87, 0x88, 0x9F, 0x00, //'t'
+0xD5, 0x3C, 0x3D, 0x3E, 0x3E, 0x3F, 0xD5, 0x00, 0xD9, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0xD9, 0x00, //'u'
+0x91, 0x2F, 0x30, 0x31, 0x32, 0x32, 0x91, 0x00, 0x95, 0x6C, 0x6D, 0x6D, 0x6E, 0x6F, 0x95, 0x00, //'v'
+0xCD, 0x23, 0x24, 0x24, 0x25, 0x26, 0xCD, 0x00, 0xD1, 0x5F, 0x60, 0x61, 0x62, 0x62, 0xD1, 0x00, //'w'
+0x89, 0x16, 0x17, 0x18, 0x18, 0x19, 0x89, 0x00, 0x8D, 0x53, 0x53, 0x54, 0x55, 0x56, 0x8D, 0x00, //'x'
+0xC5, 0x0A, 0x0A, 0x0B, 0x0C, 0x0D, 0xC5, 0x00, 0xC9, 0x46, 0x47, 0x48, 0x48, 0x49, 0xC9, 0x00, //'y'
+0xFF, 0xFD, 0xFE, 0xFE, 0xFF, 0x00, 0x81, 0x00, 0x85, 0x39, 0x3A, 0x3B, 0x3C, 0x3C, 0x85, 0x00, //'z'
+0xBB, 0xF0, 0xF1, 0xF2, 0xF3, 0xF3, 0xBB, 0x00, 0xC1, 0x2D, 0x2E, 0x2E, 0x2F, 0x30, 0xC1, 0x00, //'{'
+0xF7, 0xE4, 0xE4, 0xE5, 0xE6, 0xE7, 0xF7, 0x00, 0xFD, 0x20, 0x21, 0x22, 0x22, 0x23, 0xFD, 0x00, //'|'
+0xB3, 0xD7, 0xD8, 0xD9, 0xD9, 0xDA, 0xB3, 0x00, 0xB9, 0x14, 0x14, 0x15, 0x16, 0x17, 0xB9, 0x00, //'}'
+0xEF, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xEF, 0x00, 0xF5, 0x07, 0x08, 0x08, 0x09, 0x0A, 0xF5, 0x00, //'~'
+0xAB, 0xBE, 0xBF, 0xBF, 0xC0, 0xC1, 0xAB, 0x00, 0xAF, 0xFA, 0xFB, 0xFC, 0xFD, 0xFD, 0xAF, 0x00, //''
+};
+
+const uint8_t courier_new_font11x16_digits[] PROGMEM = {
+0x00, 0x0B, 0x10, 0x2C, //11x16, ',' to ':'
+0xC7, 0xD5, 0xD6, 0xD7, 0xD7, 0xD8, 0xD9, 0xDA, 0xDA, 0xC7, 0x00, 0xCD, 0x12, 0x12, 0x13, 0x14, 0x15, 0x15, 0x16, 0x17, 0xCD, 0x00, //','
+0x83, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCC, 0xCD, 0xCE, 0x83, 0x00, 0x89, 0x05, 0x06, 0x06, 0x07, 0x08, 0x09, 0x09, 0x0A, 0x89, 0x00, //'-'
+0xBF, 0xBC, 0xBD, 0xBD, 0xBE, 0xBF, 0xC0, 0xC0, 0xC1, 0xBF, 0x00, 0xC3, 0xF8, 0xF9, 0xFA, 0xFB, 0xFB, 0xFC, 0xFD, 0xFE, 0xC3, 0x00, //'.'
+0xFB, 0xAF, 0xB0, 0xB1, 0xB2, 0xB2, 0xB3, 0xB4, 0xB5, 0xFB, 0x00, 0xFF, 0xEC, 0xEC, 0xED, 0xEE, 0xEF, 0xEF, 0xF0, 0xF1, 0xFF, 0x00, //'/'
+0xB7, 0xA3, 0xA3, 0xA4, 0xA5, 0xA6, 0xA6, 0xA7, 0xA8, 0xB7, 0x00, 0xBB, 0xDF, 0xE0, 0xE1, 0xE1, 0xE2, 0xE3, 0xE4, 0xE4, 0xBB, 0x00, //'0'
+0xF3, 0x96, 0x97, 0x98, 0x98, 0x99, 0x9A, 0x9B, 0x9B, 0xF3, 0x00, 0xF7, 0xD2, 0xD3, 0xD4, 0xD5, 0xD5, 0xD6, 0xD7, 0xD8, 0xF7, 0x00, //'1'
+0xAF, 0x89, 0x8A, 0x8B, 0x8C, 0x8C, 0x8D, 0x8E, 0x8F, 0xAF, 0x00, 0xB3, 0xC6, 0xC7, 0xC7, 0xC8, 0xC9, 0xCA, 0xCA, 0xCB, 0xB3, 0x00, //'2'
+0xE9, 0x7D, 0x7E, 0x7E, 0x7F, 0x80, 0x81, 0x81, 0x82, 0xEB, 0x00, 0xEF, 0xB9, 0xBA, 0xBB, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF, 0xEF, 0x00, //'3'
+0xA5, 0x70, 0x71, 0x72, 0x72, 0x73, 0x74, 0x75, 0x75, 0xA5, 0x00, 0xAB, 0xAD, 0xAD, 0xAE, 0xAF, 0xB0, 0xB0, 0xB1, 0xB2, 0xAB, 0x00, //'4'
+0xE1, 0x64, 0x64, 0x65, 0x66, 0x67, 0x67, 0x68, 0x69, 0xE1, 0x00, 0xE7, 0xA0, 0xA1, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA5, 0xE7, 0x00, //'5'
+0x9D, 0x57, 0x58, 0x58, 0x59, 0x5A, 0x5B, 0x5B, 0x5C, 0x9D, 0x00, 0xA3, 0x93, 0x94, 0x95, 0x96, 0x96, 0x97, 0x98, 0x99, 0xA3, 0x00, //'6'
+0xD9, 0x4A, 0x4B, 0x4C, 0x4D, 0x4D, 0x4E, 0x4F, 0x50, 0xD9, 0x00, 0xDF, 0x87, 0x88, 0x88, 0x89, 0x8A, 0x8B, 0x8B, 0x8C, 0xDF, 0x00, //'7'
+0x95, 0x3E, 0x3E, 0x3F, 0x40, 0x41, 0x41, 0x42, 0x43, 0x95, 0x00, 0x99, 0x7A, 0x7B, 0x7C, 0x7C, 0x7D, 0x7E, 0x7F, 0x7F, 0x9B, 0x00, //'8'
+0xD1, 0x31, 0x32, 0x33, 0x33, 0x34, 0x35, 0x36, 0x36, 0xD1, 0x00, 0xD5, 0x6E, 0x6E, 0x6F, 0x70, 0x71, 0x71, 0x72, 0x73, 0xD5, 0x00, //'9'
+0x8D, 0x24, 0x25, 0x26, 0x27, 0x27, 0x28, 0x29, 0x2A, 0x8D, 0x00, 0x91, 0x61, 0x62, 0x62, 0x63, 0x64, 0x65, 0x65, 0x66, 0x91, 0x00, //':'
+};
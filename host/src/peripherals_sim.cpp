@@ -0,0 +1,209 @@
+//Simulated flash (NVM controller), DS1302 clock and servo behind the library stand-ins.
+
+#include <map>
+#include <vector>
+
+#include "FlashStorage.h"
+#include "DS1302.h"
+#include "Servo.h"
+
+//Flash: rows of 256 bytes, pages of 64 bytes. Untouched rows read back the image
+//contents (the linker fills FlashStorage regions with zeros).
+
+#define SIM_ROW_SIZE 256
+#define SIM_PAGE_SIZE 64
+
+static std::map<uintptr_t, std::vector<uint8_t> > nvm_rows;
+
+static std::vector<uint8_t>& nvmRow(uintptr_t row_base){
+  std::map<uintptr_t, std::vector<uint8_t> >::iterator it = nvm_rows.find(row_base);
+  if(it == nvm_rows.end()){
+    std::vector<uint8_t> row(SIM_ROW_SIZE);
+    const volatile uint8_t* image = (const volatile uint8_t*)row_base;
+    for(int i = 0; i < SIM_ROW_SIZE; i++){
+      row[i] = image[i];
+    }
+    it = nvm_rows.insert(std::make_pair(row_base, row)).first;
+  }
+  return it->second;
+}
+
+void FlashClass::write(const volatile void* flash_ptr, const void* data, uint32_t size){
+  uintptr_t address = (uintptr_t)flash_ptr;
+  const uint8_t* src = (const uint8_t*)data;
+  uint32_t length = (size + 3) / 4 * 4; //The NVM is written in 32-bit words
+  uintptr_t last_page = (uintptr_t)-1;
+  for(uint32_t i = 0; i < length; i++, address++){
+    if(address / SIM_PAGE_SIZE != last_page){
+      last_page = address / SIM_PAGE_SIZE;
+      sim_stats.flash_page_writes++;
+      sim_advance(SIM_FLASH_WRITE_US);
+    }
+    uint8_t value = i < size ? src[i] : 0xFF;
+    nvmRow(address & ~(uintptr_t)(SIM_ROW_SIZE - 1))[address % SIM_ROW_SIZE] &= value; //Programming only clears bits
+  }
+}
+
+void FlashClass::erase(const volatile void* flash_ptr, uint32_t size){
+  uintptr_t row_base = (uintptr_t)flash_ptr & ~(uintptr_t)(SIM_ROW_SIZE - 1);
+  uintptr_t end = (uintptr_t)flash_ptr + size;
+  for(; row_base < end; row_base += SIM_ROW_SIZE){
+    std::vector<uint8_t>& row = nvmRow(row_base);
+    for(int i = 0; i < SIM_ROW_SIZE; i++){
+      row[i] = 0xFF;
+    }
+    sim_stats.flash_row_erases++;
+    sim_advance(SIM_FLASH_ERASE_US);
+  }
+}
+
+void FlashClass::read(const volatile void* flash_ptr, void* data, uint32_t size){
+  uintptr_t address = (uintptr_t)flash_ptr;
+  uint8_t* dst = (uint8_t*)data;
+  for(uint32_t i = 0; i < size; i++, address++){
+    dst[i] = nvmRow(address & ~(uintptr_t)(SIM_ROW_SIZE - 1))[address % SIM_ROW_SIZE];
+  }
+}
+
+//DS1302: a Unix time base that runs with the virtual clock unless stopped.
+
+static uint32_t rtc_base = 1629547200; //2021-08-21 12:00:00
+static uint64_t rtc_base_at = 0; //sim_now() when rtc_base was set
+static bool rtc_stopped = false;
+static int32_t rtc_drift_ppm = 0; //How much faster the DS1302 runs than the virtual clock
+static uint8_t rtc_ram[DS1302::kRamSize] = {0};
+
+static uint32_t rtcNow(){
+  uint64_t elapsed_us = sim_now() - rtc_base_at;
+  elapsed_us += (int64_t)elapsed_us * rtc_drift_ppm / 1000000;
+  return rtc_stopped ? rtc_base : rtc_base + (uint32_t)(elapsed_us / 1000000);
+}
+
+static void rtcTransfer(){
+  sim_advance(SIM_RTC_TRANSFER_US);
+}
+
+void sim_rtc_set(uint32_t unix_time){
+  rtc_base = unix_time;
+  rtc_base_at = sim_now();
+}
+
+void sim_rtc_stop(bool stopped){
+  if(stopped != rtc_stopped){
+    sim_rtc_set(rtcNow());
+    rtc_stopped = stopped;
+  }
+}
+
+void sim_rtc_drift(int32_t ppm){
+  sim_rtc_set(rtcNow());
+  rtc_drift_ppm = ppm;
+}
+
+void sim_rtc_corrupt_ram(){
+  for(int i = 0; i < DS1302::kRamSize; i++){
+    rtc_ram[i] = (uint8_t)(i * 37 + 11);
+  }
+}
+
+void DS1302::writeProtect(bool enable){
+  rtcTransfer();
+}
+
+void DS1302::halt(bool value){
+  rtcTransfer();
+  sim_rtc_stop(value);
+}
+
+Time DS1302::time(){
+  rtcTransfer();
+  sim_stats.rtc_reads++;
+  uint32_t t = rtcNow();
+  uint32_t days = t / 86400;
+  uint32_t secs = t % 86400;
+  //Civil date from days since 1970-01-01 (proleptic Gregorian).
+  uint32_t z = days + 719468;
+  uint32_t era = z / 146097;
+  uint32_t doe = z - era * 146097;
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+  uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+  uint32_t y = yoe + era * 400 + (m <= 2);
+  Time::Day day = (Time::Day)((days + 4) % 7 + 1); //1970-01-01 was a Thursday
+  return Time(y, m, d, secs / 3600, secs / 60 % 60, secs % 60, day);
+}
+
+void DS1302::time(Time t){
+  rtcTransfer();
+  //Days since 1970-01-01 from the civil date (proleptic Gregorian).
+  int y = t.yr - (t.mon <= 2);
+  int era = y / 400;
+  int yoe = y - era * 400;
+  int doy = (153 * (t.mon + (t.mon > 2 ? -3 : 9)) + 2) / 5 + t.date - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  uint32_t days = era * 146097 + doe - 719468;
+  sim_rtc_set(days * 86400 + t.hr * 3600 + t.min * 60 + t.sec);
+}
+
+void DS1302::writeRam(uint8_t address, uint8_t value){
+  rtcTransfer();
+  sim_stats.rtc_ram_transfers++;
+  if(address < kRamSize){
+    rtc_ram[address] = value;
+  }
+}
+
+uint8_t DS1302::readRam(uint8_t address){
+  rtcTransfer();
+  sim_stats.rtc_ram_transfers++;
+  return address < kRamSize ? rtc_ram[address] : 0;
+}
+
+void DS1302::writeRamBulk(const uint8_t* data, int len){
+  rtcTransfer();
+  sim_stats.rtc_ram_transfers++;
+  for(int i = 0; i < len && i < kRamSize; i++){
+    rtc_ram[i] = data[i];
+  }
+}
+
+void DS1302::readRamBulk(uint8_t* data, int len){
+  rtcTransfer();
+  sim_stats.rtc_ram_transfers++;
+  for(int i = 0; i < len && i < kRamSize; i++){
+    data[i] = rtc_ram[i];
+  }
+}
+
+//Servo
+
+uint8_t Servo::attach(int pin){
+  if(this->pin != pin){
+    sim_stats.servo_attaches++;
+  }
+  this->pin = pin;
+  return 0;
+}
+
+void Servo::detach(){
+  pin = -1;
+}
+
+void Servo::write(int value){
+  sim_stats.servo_writes++;
+  angle = value;
+}
+
+void Servo::writeMicroseconds(int value){
+  write((value - 544) * 180 / (2400 - 544));
+}
+
+int Servo::read(){
+  return angle;
+}
+
+bool Servo::attached(){
+  return pin != -1;
+}
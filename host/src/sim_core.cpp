@@ -0,0 +1,426 @@
+//Virtual clock, pins, interrupts, Serial and LowPower for the host simulator,
+//plus the script engine that drives button input while the sketch runs or sleeps.
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <deque>
+
+#include "Arduino.h"
+#include "ArduinoLowPower.h"
+#include "DS1302.h"
+#include "ssd1306.h"
+#include "SimScript.h"
+
+SimStats sim_stats;
+bool sim_serial_connected = false;
+SimSerial Serial;
+ArduinoLowPowerClass LowPower;
+
+#define SIM_PINS 32
+#define SIM_NO_DEADLINE ((uint64_t)-1)
+
+static uint64_t now_us = 0;
+static uint8_t pin_level[SIM_PINS] = {0};
+static void (*pin_isr[SIM_PINS])(void) = {0};
+static uint32_t pin_isr_mode[SIM_PINS] = {0};
+static bool pin_wakes[SIM_PINS] = {0};
+static void (*rtc_alarm_isr)(void) = NULL;
+static int servo_transistor_pin = -1;
+static uint64_t interrupts_disabled_at = SIM_NO_DEADLINE;
+static std::deque<uint8_t> serial_input;
+
+uint64_t sim_now(){
+  return now_us;
+}
+
+void sim_advance(uint64_t us){
+  if(servo_transistor_pin >= 0 && pin_level[servo_transistor_pin]){
+    sim_stats.servo_powered_us += us;
+  }
+  now_us += us;
+}
+
+unsigned long millis(){
+  return (unsigned long)(uint32_t)(now_us / 1000);
+}
+
+unsigned long micros(){
+  return (unsigned long)(uint32_t)now_us;
+}
+
+void delay(unsigned long ms){
+  sim_advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us){
+  sim_advance(us);
+}
+
+void pinMode(uint32_t pin, uint32_t mode){}
+
+void digitalWrite(uint32_t pin, uint32_t value){
+  if(pin < SIM_PINS){
+    pin_level[pin] = value ? 1 : 0;
+  }
+}
+
+int digitalRead(uint32_t pin){
+  return pin < SIM_PINS ? pin_level[pin] : 0;
+}
+
+static int analog_value[SIM_PINS] = {0};
+
+int analogRead(uint32_t pin){
+  sim_advance(20);
+  return pin < SIM_PINS ? analog_value[pin] : 0;
+}
+
+void analogReadResolution(int bits){}
+
+void attachInterrupt(uint32_t pin, void (*callback)(void), uint32_t mode){
+  if(pin < SIM_PINS){
+    pin_isr[pin] = callback;
+    pin_isr_mode[pin] = mode;
+  }
+}
+
+void detachInterrupt(uint32_t pin){
+  if(pin < SIM_PINS){
+    pin_isr[pin] = NULL;
+    pin_wakes[pin] = false;
+  }
+}
+
+void noInterrupts(){
+  if(interrupts_disabled_at == SIM_NO_DEADLINE){
+    interrupts_disabled_at = now_us;
+  }
+}
+
+void interrupts(){
+  if(interrupts_disabled_at != SIM_NO_DEADLINE){
+    sim_stats.interrupts_disabled_us += now_us - interrupts_disabled_at;
+    interrupts_disabled_at = SIM_NO_DEADLINE;
+  }
+}
+
+//Serial
+
+int SimSerial::available(){
+  return serial_input.size();
+}
+
+int SimSerial::read(){
+  if(serial_input.empty()){
+    return -1;
+  }
+  uint8_t c = serial_input.front();
+  serial_input.pop_front();
+  return c;
+}
+
+size_t SimSerial::write(uint8_t b){
+  if(sim_serial_connected){
+    putchar(b);
+  }
+  return 1;
+}
+
+size_t SimSerial::write(const uint8_t* data, size_t len){
+  for(size_t i = 0; i < len; i++){
+    write(data[i]);
+  }
+  return len;
+}
+
+size_t SimSerial::print(const char* s){
+  return write((const uint8_t*)s, strlen(s));
+}
+
+size_t SimSerial::print(unsigned long v, int base){
+  char buf[34];
+  if(base == 16){
+    snprintf(buf, sizeof(buf), "%lX", v);
+  }else{
+    snprintf(buf, sizeof(buf), "%lu", v);
+  }
+  return print(buf);
+}
+
+size_t SimSerial::print(long v, int base){
+  if(base != 10){
+    return print((unsigned long)v, base);
+  }
+  char buf[34];
+  snprintf(buf, sizeof(buf), "%ld", v);
+  return print(buf);
+}
+
+size_t SimSerial::print(double v, int digits){
+  char buf[40];
+  snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return print(buf);
+}
+
+//Script engine
+
+struct SimButton{
+  std::string name;
+  int pin;
+};
+
+static std::vector<SimButton> buttons;
+static std::vector<std::string> script;
+static size_t script_line = 0;
+static uint64_t busy_until = 0; //End of the current `wait` or button hold
+static int release_pin = -1; //Button to release when the current hold ends
+static bool sleeping = false;
+static bool echo_commands = false;
+
+void sim_registerButton(const char* name, int pin){
+  SimButton b = {name, pin};
+  buttons.push_back(b);
+}
+
+void sim_registerServoTransistor(int pin){
+  servo_transistor_pin = pin;
+}
+
+void sim_loadScript(std::istream& in){
+  std::string line;
+  while(std::getline(in, line)){
+    script.push_back(line);
+  }
+}
+
+void sim_setEcho(bool echo){
+  echo_commands = echo;
+}
+
+uint64_t sim_busyUntil(){
+  return busy_until;
+}
+
+static void fireEdge(int pin, uint8_t level){
+  uint8_t previous = pin_level[pin];
+  pin_level[pin] = level;
+  if(previous == level){
+    return;
+  }
+  if(sleeping){
+    if(pin_wakes[pin] && pin_isr[pin]){
+      sleeping = false;
+      pin_isr[pin]();
+    }
+    return;
+  }
+  uint32_t mode = pin_isr_mode[pin];
+  if(pin_isr[pin] && (mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level))){
+    pin_isr[pin]();
+  }
+}
+
+static int buttonPin(const std::string& name){
+  for(size_t i = 0; i < buttons.size(); i++){
+    if(buttons[i].name == name){
+      return buttons[i].pin;
+    }
+  }
+  fprintf(stderr, "sim: unknown button '%s'\n", name.c_str());
+  exit(2);
+}
+
+bool sim_runCommand(){
+  if(release_pin >= 0){
+    fireEdge(release_pin, LOW);
+    release_pin = -1;
+  }
+  while(script_line < script.size()){
+    std::string line = script[script_line++];
+    std::istringstream words(line);
+    std::string command;
+    if(!(words >> command) || command[0] == '#'){
+      continue;
+    }
+    if(echo_commands){
+      printf("[%10.3f] %s\n", now_us / 1e6, line.c_str());
+    }
+    if(command == "wait"){
+      double ms = 0;
+      words >> ms;
+      busy_until = now_us + (uint64_t)(ms * 1000);
+      return true;
+    }else if(command == "press" || command == "hold"){
+      std::string name;
+      double ms = command == "press" ? 80 : 1000;
+      words >> name >> ms;
+      int pin = buttonPin(name);
+      fireEdge(pin, HIGH);
+      release_pin = pin;
+      busy_until = now_us + (uint64_t)(ms * 1000);
+      return true;
+    }else if(command == "reset"){
+      //Power cycle: flash, the DS1302 and the virtual clock survive; the display is reinitialized.
+      //Static RAM is not cleared, but setup() reinitializes everything the sketch relies on.
+      for(int pin = 0; pin < SIM_PINS; pin++){
+        pin_isr[pin] = NULL;
+        pin_wakes[pin] = false;
+        pin_level[pin] = LOW;
+      }
+      rtc_alarm_isr = NULL;
+      sleeping = false; //The reset wakes the processor; what the sketch was doing is abandoned
+      throw SimReset();
+    }else if(command == "screen"){
+      sim_display_print();
+    }else if(command == "stats"){
+      sim_printStats();
+    }else if(command == "rtc"){
+      std::string what;
+      words >> what;
+      if(what == "set"){
+        unsigned long t = 0;
+        words >> t;
+        sim_rtc_set(t);
+      }else if(what == "stop"){
+        sim_rtc_stop(true);
+      }else if(what == "start"){
+        sim_rtc_stop(false);
+      }else if(what == "corrupt"){
+        sim_rtc_corrupt_ram();
+      }else if(what == "drift"){
+        long ppm = 0;
+        words >> ppm;
+        sim_rtc_drift((int32_t)ppm);
+      }
+    }else if(command == "analog"){
+      int pin = 0, value = 0;
+      words >> pin >> value;
+      if(pin >= 0 && pin < SIM_PINS){
+        analog_value[pin] = value;
+      }
+    }else if(command == "serial"){
+      std::string what;
+      words >> what;
+      if(what == "connect"){
+        sim_serial_connected = true;
+      }else if(what == "disconnect"){
+        sim_serial_connected = false;
+      }else if(what == "send"){
+        std::string rest;
+        std::getline(words, rest);
+        for(size_t i = rest.find_first_not_of(' '); i < rest.size(); i++){
+          serial_input.push_back(rest[i]);
+        }
+      }
+    }else if(command == "echo"){
+      std::string rest;
+      std::getline(words, rest);
+      printf("%s\n", rest.c_str() + (rest.empty() ? 0 : 1));
+    }else{
+      fprintf(stderr, "sim: unknown command '%s' on line %u\n", command.c_str(), (unsigned)script_line);
+      exit(2);
+    }
+  }
+  return false;
+}
+
+//LowPower
+
+void sim_idle(uint64_t max_us){
+  uint64_t until = busy_until > now_us ? busy_until : now_us;
+  if(max_us < until - now_us){
+    until = now_us + max_us;
+  }
+  sim_stats.idle_us += until - now_us;
+  sim_advance(until - now_us);
+}
+
+void sim_deepSleep(uint64_t max_us){
+  uint64_t alarm = max_us ? now_us + max_us : SIM_NO_DEADLINE;
+  sleeping = true;
+  while(sleeping){
+    uint64_t until = busy_until > now_us ? busy_until : now_us;
+    if(alarm <= until){
+      sim_stats.sleep_us += alarm - now_us;
+      sim_advance(alarm - now_us);
+      sleeping = false;
+      if(rtc_alarm_isr){
+        rtc_alarm_isr();
+      }
+      return;
+    }
+    sim_stats.sleep_us += until - now_us;
+    sim_advance(until - now_us);
+    if(!sim_runCommand()){
+      sim_finish();
+    }
+  }
+}
+
+void ArduinoLowPowerClass::idle(void){
+  sim_idle(1000); //SysTick wakes the core every millisecond
+}
+
+void ArduinoLowPowerClass::idle(uint32_t millis){
+  sim_idle((uint64_t)millis * 1000 < 1000 ? (uint64_t)millis * 1000 : 1000);
+}
+
+void ArduinoLowPowerClass::sleep(void){
+  sim_deepSleep(0);
+}
+
+void ArduinoLowPowerClass::sleep(uint32_t millis){
+  sim_deepSleep((uint64_t)millis * 1000);
+}
+
+void ArduinoLowPowerClass::deepSleep(void){
+  sim_deepSleep(0);
+}
+
+void ArduinoLowPowerClass::deepSleep(uint32_t millis){
+  sim_deepSleep((uint64_t)millis * 1000);
+}
+
+void ArduinoLowPowerClass::attachInterruptWakeup(uint32_t pin, voidFuncPtr callback, irq_mode mode){
+  if(pin == RTC_ALARM_WAKEUP){
+    rtc_alarm_isr = callback;
+    return;
+  }
+  attachInterrupt(pin, callback, mode);
+  if(pin < SIM_PINS){
+    pin_wakes[pin] = true;
+  }
+}
+
+//Report
+
+void sim_printStats(){
+  uint64_t awake = now_us - sim_stats.idle_us - sim_stats.sleep_us;
+  printf("time_ms=%llu awake_ms=%llu idle_ms=%llu sleep_ms=%llu\n",
+         (unsigned long long)(now_us / 1000), (unsigned long long)(awake / 1000),
+         (unsigned long long)(sim_stats.idle_us / 1000), (unsigned long long)(sim_stats.sleep_us / 1000));
+  printf("i2c_bytes=%llu i2c_transactions=%llu\n",
+         (unsigned long long)sim_stats.i2c_bytes, (unsigned long long)sim_stats.i2c_transactions);
+  printf("flash_row_erases=%llu flash_page_writes=%llu\n",
+         (unsigned long long)sim_stats.flash_row_erases, (unsigned long long)sim_stats.flash_page_writes);
+  printf("rtc_reads=%llu rtc_ram_transfers=%llu\n",
+         (unsigned long long)sim_stats.rtc_reads, (unsigned long long)sim_stats.rtc_ram_transfers);
+  printf("servo_attaches=%llu servo_writes=%llu servo_powered_ms=%llu\n",
+         (unsigned long long)sim_stats.servo_attaches, (unsigned long long)sim_stats.servo_writes,
+         (unsigned long long)(sim_stats.servo_powered_us / 1000));
+  printf("string_allocations=%llu interrupts_disabled_us=%llu loop_iterations=%llu\n",
+         (unsigned long long)sim_stats.string_allocations, (unsigned long long)sim_stats.interrupts_disabled_us,
+         (unsigned long long)sim_stats.loop_iterations);
+}
+
+void sim_finish(){
+  if(release_pin >= 0){
+    fireEdge(release_pin, LOW);
+    release_pin = -1;
+  }
+  sim_printStats();
+  fflush(stdout);
+  exit(0);
+}
@@ -0,0 +1,55 @@
+//Host simulator entry point: runs setup() and then loop() against the scripted input.
+//Usage: lockbox_sim [-v] [script]   (reads the script from stdin when no file is given)
+
+#include <fstream>
+#include <iostream>
+
+#include "Arduino.h"
+#include "SimScript.h"
+
+void setup();
+void loop();
+void sim_registerSketch();
+
+#define SIM_LOOP_US 20 //Cost charged for a loop() pass that did not advance the clock itself
+
+int main(int argc, char** argv){
+  const char* path = NULL;
+  for(int i = 1; i < argc; i++){
+    if(strcmp(argv[i], "-v") == 0){
+      sim_setEcho(true);
+    }else{
+      path = argv[i];
+    }
+  }
+  if(path){
+    std::ifstream file(path);
+    if(!file){
+      fprintf(stderr, "sim: cannot open %s\n", path);
+      return 2;
+    }
+    sim_loadScript(file);
+  }else{
+    sim_loadScript(std::cin);
+  }
+
+  sim_registerSketch();
+  setup();
+  while(true){
+    try{
+      if(sim_now() < sim_busyUntil()){
+        uint64_t before = sim_now();
+        loop();
+        sim_stats.loop_iterations++;
+        if(sim_now() == before){
+          sim_advance(SIM_LOOP_US);
+        }
+      }else if(!sim_runCommand()){
+        break;
+      }
+    }catch(const SimReset&){
+      setup();
+    }
+  }
+  sim_finish();
+}
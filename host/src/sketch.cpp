@@ -0,0 +1,15 @@
+//Compiles the real sketch for the host. The Arduino IDE would add the Arduino.h include
+//and the function prototypes; the sketch already declares everything before use.
+
+#include "Arduino.h"
+#include "SimScript.h"
+
+#include "../../LockBoxCode.ino"
+
+void sim_registerSketch(){
+  sim_registerButton("up", UP_BUTTON_PIN);
+  sim_registerButton("down", DOWN_BUTTON_PIN);
+  sim_registerButton("left", LEFT_BUTTON_PIN);
+  sim_registerButton("right", RIGHT_BUTTON_PIN);
+  sim_registerServoTransistor(SERVO_TRANSISTOR_PIN);
+}
@@ -0,0 +1,155 @@
+//Simulated SSD1306 panel behind the ssd1306 library stand-in.
+//Each drawing call is charged as the real library would send it: one addressing
+//transaction (control byte + column/page window) and one data transaction per page.
+
+#include "ssd1306.h"
+
+static uint8_t gddram[8][128];
+static bool display_on = false;
+static bool inverted = false;
+static const uint8_t* fixed_font = NULL;
+
+static void chargeTransaction(uint32_t payload){
+  sim_stats.i2c_transactions++;
+  sim_stats.i2c_bytes += 1 + payload; //Address byte + payload
+  sim_advance((1 + payload) * SIM_I2C_US_PER_BYTE);
+}
+
+//Sets the column/page window and then streams the data bytes for one page.
+static void sendPage(uint8_t x, uint8_t page, const uint8_t* data, uint8_t w){
+  if(page > 7 || x > 127){
+    return;
+  }
+  if(x + w > 128){
+    w = 128 - x;
+  }
+  chargeTransaction(1 + 6); //Control byte, 0x21 x0 x1, 0x22 p0 p1
+  chargeTransaction(1 + w); //Control byte + data
+  memcpy(&gddram[page][x], data, w);
+}
+
+void ssd1306_sendCommand(uint8_t command){
+  chargeTransaction(2);
+  if(command == 0xAE){
+    display_on = false;
+  }else if(command == 0xAF){
+    display_on = true;
+  }
+}
+
+void ssd1306_128x64_i2c_init(void){
+  //The real init sequence is about 25 command bytes.
+  chargeTransaction(26);
+  display_on = true;
+  inverted = false;
+}
+
+void ssd1306_displayOn(void){
+  ssd1306_sendCommand(0xAF);
+}
+
+void ssd1306_displayOff(void){
+  ssd1306_sendCommand(0xAE);
+}
+
+void ssd1306_clearScreen(void){
+  uint8_t zeros[128] = {0};
+  for(uint8_t page = 0; page < 8; page++){
+    sendPage(0, page, zeros, 128);
+  }
+}
+
+void ssd1306_setFixedFont(const uint8_t* progmemFont){
+  fixed_font = progmemFont;
+}
+
+void ssd1306_negativeMode(void){
+  inverted = true;
+}
+
+void ssd1306_positiveMode(void){
+  inverted = false;
+}
+
+lcduint_t ssd1306_getTextSize(const char* text, lcduint_t* height){
+  if(height){
+    *height = fixed_font[2];
+  }
+  return strlen(text) * fixed_font[1];
+}
+
+uint8_t ssd1306_printFixed(uint8_t xpos, uint8_t y, const char* ch, EFontStyle style){
+  const uint8_t width = fixed_font[1];
+  const uint8_t pages = fixed_font[2] / 8;
+  const uint8_t first = fixed_font[3];
+  const uint8_t* glyphs = fixed_font + 4;
+  size_t length = strlen(ch);
+  uint8_t row[128];
+  for(uint8_t p = 0; p < pages; p++){
+    uint8_t n = 0;
+    uint8_t last = 0;
+    for(size_t i = 0; i < length && xpos + n < 128; i++){
+      const uint8_t* glyph = glyphs + (uint16_t)((uint8_t)ch[i] - first) * width * pages + p * width;
+      for(uint8_t col = 0; col < width && xpos + n < 128; col++){
+        uint8_t data = pgm_read_byte(glyph + col);
+        if(style == STYLE_BOLD){
+          uint8_t bold = data | last;
+          last = data;
+          data = bold;
+        }
+        row[n++] = inverted ? ~data : data;
+      }
+    }
+    sendPage(xpos, y / 8 + p, row, n);
+  }
+  return xpos + length * width;
+}
+
+void ssd1306_drawBitmap(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* buf){
+  uint8_t row[128];
+  for(uint8_t p = 0; p < h / 8; p++){
+    for(uint8_t col = 0; col < w; col++){
+      uint8_t data = pgm_read_byte(buf + p * w + col);
+      row[col] = inverted ? ~data : data;
+    }
+    sendPage(x, y + p, row, w);
+  }
+}
+
+void ssd1306_drawBuffer(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* buf){
+  for(uint8_t p = 0; p < h / 8; p++){
+    sendPage(x, y + p, buf + p * w, w);
+  }
+}
+
+void ssd1306_clearBlock(uint8_t x, uint8_t y, uint8_t w, uint8_t h){
+  uint8_t zeros[128] = {0};
+  for(uint8_t p = 0; p < h / 8; p++){
+    sendPage(x, y + p, zeros, w);
+  }
+}
+
+const uint8_t* sim_display_gddram(){
+  return &gddram[0][0];
+}
+
+bool sim_display_on(){
+  return display_on;
+}
+
+void sim_display_print(){
+  //Two pixel rows per text line: ' ' both off, '\'' top only, ',' bottom only, ':' both.
+  static const char shades[4] = {' ', '\'', ',', ':'};
+  printf("+--------------------------------------------------------------------------------------------------------------------------------+%s\n", display_on ? "" : " (off)");
+  for(uint8_t y = 0; y < 64; y += 2){
+    char line[129];
+    for(uint8_t x = 0; x < 128; x++){
+      uint8_t top = (gddram[y / 8][x] >> (y % 8)) & 1;
+      uint8_t bottom = (gddram[y / 8][x] >> (y % 8 + 1)) & 1;
+      line[x] = shades[top | (bottom << 1)];
+    }
+    line[128] = 0;
+    printf("|%s|\n", line);
+  }
+  printf("+--------------------------------------------------------------------------------------------------------------------------------+\n");
+}
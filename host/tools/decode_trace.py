@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Decodes the event trace dumped over serial from the diagnostics screen (see EventTrace.h).
+
+Usage: decode_trace.py [--events] [capture]
+
+The capture is a file of everything read from the serial port (standard input if it is left
+out); the last trace dump in it is decoded. Prints latency histograms of the button presses and
+the handlers, and with --events the events themselves.
+"""
+
+import struct
+import sys
+
+ENTRY = struct.Struct("<IBBBB")  # time (micros()), type, a, b, unused
+
+EVENT_NAMES = {
+    1: "isr", 2: "debounce_reject", 3: "handler_start", 4: "handler_end", 5: "transfer",
+    6: "flash", 7: "servo_on", 8: "servo_off", 9: "sleep", 10: "wake", 11: "frame",
+}
+TRACE_ISR, TRACE_DEBOUNCE_REJECT, TRACE_HANDLER_START, TRACE_HANDLER_END = 1, 2, 3, 4
+TRACE_FLASH_WRITE, TRACE_FRAME = 6, 11
+TRACE_TICK = 0xFF
+WAKE_EVENT = 4
+BUTTON_NAMES = {0: "up", 1: "down", 2: "left", 3: "right", 4: "wake", TRACE_TICK: "tick"}
+
+
+def read_dump(data):
+    """Returns the entries of the last dump in data as (time, type, a, b) tuples."""
+    start = data.rfind(b"trace=")
+    if start < 0:
+        raise ValueError("no trace dump found")
+    line_end = data.index(b"\n", start)
+    count = int(data[start + len(b"trace="):line_end].strip())
+    body = data[line_end + 1:line_end + 1 + count * ENTRY.size]
+    if len(body) < count * ENTRY.size:
+        raise ValueError("the dump is cut short")
+    return [ENTRY.unpack_from(body, i * ENTRY.size)[:4] for i in range(count)]
+
+
+def elapsed(start, end):
+    return (end - start) & 0xFFFFFFFF  # micros() wraps after 71 minutes
+
+
+def describe(event_type, a, b):
+    name = EVENT_NAMES.get(event_type, "type%d" % event_type)
+    if event_type in (TRACE_ISR, TRACE_DEBOUNCE_REJECT):
+        return "%s %s" % (name, BUTTON_NAMES.get(a, a))
+    if event_type in (TRACE_HANDLER_START, TRACE_HANDLER_END):
+        return "%s %s state=%d" % (name, BUTTON_NAMES.get(a, a), b)
+    if event_type == 5:
+        return "%s %d->%d" % (name, a, b)
+    if event_type == TRACE_FLASH_WRITE:
+        return "%s %s %s" % (name, ("record", "audit")[a] if a < 2 else a, "erase" if b else "write")
+    if event_type == TRACE_FRAME:
+        return "%s pages=%d" % (name, a)
+    return name
+
+
+def histogram(title, values):
+    print("%s: %d" % (title, len(values)))
+    if not values:
+        return
+    values = sorted(values)
+    print("  min %d us, median %d us, max %d us" % (values[0], values[len(values) // 2], values[-1]))
+    buckets = {}
+    for value in values:
+        bucket = 1
+        while bucket < value:
+            bucket *= 2
+        buckets[bucket] = buckets.get(bucket, 0) + 1
+    widest = max(buckets.values())
+    for bucket in sorted(buckets):
+        bar = "#" * max(1, buckets[bucket] * 40 // widest)
+        print("  <= %8d us %5d %s" % (bucket, buckets[bucket], bar))
+
+
+def analyze(entries):
+    press_to_handler = []
+    press_to_frame = []
+    handler_time = []
+    tick_time = []
+    flash = {0: 0, 1: 0}
+    presses = rejects = undrawn = 0
+    queued = []  # ISR times of accepted presses that have not been handled yet
+    handled = []  # ISR times of handled presses that have not been drawn yet
+    handler_start = {}
+    for time, event_type, a, b in entries:
+        if event_type == TRACE_ISR:
+            presses += 1
+            queued.append((a, time))
+            undrawn += len(handled)  # A press that changes the screen is drawn before the next press
+            handled = []
+        elif event_type == TRACE_DEBOUNCE_REJECT:
+            rejects += 1
+            for i in range(len(queued) - 1, -1, -1):  # That press never reaches a handler
+                if queued[i][0] == a:
+                    del queued[i]
+                    break
+        elif event_type == TRACE_HANDLER_START:
+            handler_start[a] = time
+            if queued and queued[0][0] == a:  # Repeats of a held button have no interrupt
+                press_time = queued.pop(0)[1]
+                press_to_handler.append(elapsed(press_time, time))
+                if a != WAKE_EVENT:
+                    handled.append(press_time)
+        elif event_type == TRACE_HANDLER_END and a in handler_start:
+            (tick_time if a == TRACE_TICK else handler_time).append(elapsed(handler_start.pop(a), time))
+        elif event_type == TRACE_FRAME:
+            press_to_frame.extend(elapsed(press_time, time) for press_time in handled)
+            handled = []
+        elif event_type == TRACE_FLASH_WRITE:
+            flash[b] = flash.get(b, 0) + 1
+
+    span = elapsed(entries[0][0], entries[-1][0]) if entries else 0
+    print("%d events over %.3f s" % (len(entries), span / 1e6))
+    print("button interrupts: %d, dropped by debouncing: %d" % (presses, rejects))
+    print("presses that did not change the screen: %d" % undrawn)
+    print("flash writes: %d, row erases: %d" % (flash.get(0, 0), flash.get(1, 0)))
+    histogram("press to handler", press_to_handler)
+    histogram("press to frame", press_to_frame)
+    histogram("button handlers", handler_time)
+    histogram("tick handlers", tick_time)
+
+
+def main(argv):
+    show_events = "--events" in argv
+    paths = [arg for arg in argv if arg != "--events"]
+    if len(paths) > 1:
+        sys.stderr.write(__doc__)
+        return 2
+    if paths:
+        with open(paths[0], "rb") as capture:
+            data = capture.read()
+    else:
+        data = sys.stdin.buffer.read()
+    try:
+        entries = read_dump(data)
+    except ValueError as error:
+        sys.stderr.write("decode_trace: %s\n" % error)
+        return 1
+
+    if show_events:
+        for time, event_type, a, b in entries:
+            print("%10d  %s" % (time, describe(event_type, a, b)))
+        print()
+    analyze(entries)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))